@@ -0,0 +1,135 @@
+#include "AllocationTracker.h"
+
+#ifdef TRACK_ALLOCATIONS
+#include <atomic>
+#include <new>
+#include <cstdlib>
+
+struct TrackerState
+{
+	std::atomic<int_t> numAllocations { 0 };
+	std::atomic<int_t> numBytes { 0 };
+	std::atomic<int_t> liveBytes { 0 };
+	std::atomic<int_t> peakLiveBytes { 0 };
+};
+
+// Constant initialized, so it can be used by allocations made during static initialization.
+static TrackerState trackerState;
+
+// Each block starts with its size, padded to keep the default new alignment.
+static constexpr std::size_t HeaderSize = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+static void* TrackedAllocate(std::size_t size)
+{
+	void* block = std::malloc(size + HeaderSize);
+	if (block == nullptr)
+		return nullptr;
+
+	*static_cast<std::size_t*>(block) = size;
+
+	int_t bytes = static_cast<int_t>(size);
+	trackerState.numAllocations.fetch_add(1, std::memory_order_relaxed);
+	trackerState.numBytes.fetch_add(bytes, std::memory_order_relaxed);
+	int_t live = trackerState.liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+	int_t peak = trackerState.peakLiveBytes.load(std::memory_order_relaxed);
+	while (live > peak && !trackerState.peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+		;
+
+	return static_cast<char*>(block) + HeaderSize;
+}
+
+static void TrackedFree(void* ptr)
+{
+	if (ptr == nullptr)
+		return;
+
+	void* block = static_cast<char*>(ptr) - HeaderSize;
+	trackerState.liveBytes.fetch_sub(static_cast<int_t>(*static_cast<std::size_t*>(block)), std::memory_order_relaxed);
+	std::free(block);
+}
+
+void* operator new(std::size_t size)
+{
+	void* ptr = TrackedAllocate(size);
+	if (ptr == nullptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+	void* ptr = TrackedAllocate(size);
+	if (ptr == nullptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return TrackedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return TrackedAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	TrackedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	TrackedFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	TrackedFree(ptr);
+}
+#endif
+
+bool AllocationTracker::IsEnabled()
+{
+#ifdef TRACK_ALLOCATIONS
+	return true;
+#else
+	return false;
+#endif
+}
+
+void AllocationTracker::GetCounts(Counts& outCounts)
+{
+#ifdef TRACK_ALLOCATIONS
+	outCounts.numAllocations = trackerState.numAllocations.load(std::memory_order_relaxed);
+	outCounts.numBytes = trackerState.numBytes.load(std::memory_order_relaxed);
+	outCounts.liveBytes = trackerState.liveBytes.load(std::memory_order_relaxed);
+	outCounts.peakLiveBytes = trackerState.peakLiveBytes.load(std::memory_order_relaxed);
+#else
+	outCounts = { };
+#endif
+}
+
+void AllocationTracker::ResetPeak()
+{
+#ifdef TRACK_ALLOCATIONS
+	trackerState.peakLiveBytes.store(trackerState.liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+#endif
+}
@@ -0,0 +1,26 @@
+#ifndef _ALLOCATION_TRACKER_H_
+#define _ALLOCATION_TRACKER_H_
+
+#include "Common.h"
+
+
+// Counts the heap allocations made through the global operator new. The replacement operators are compiled in
+// only with TRACK_ALLOCATIONS defined, otherwise all counts stay zero. Counts are shared by all threads.
+class AllocationTracker
+{
+public:
+	struct Counts
+	{
+		int_t numAllocations = 0;
+		int_t numBytes = 0;			// Requested bytes of all allocations.
+		int_t liveBytes = 0;
+		int_t peakLiveBytes = 0;	// Highest live bytes since the last ResetPeak().
+	};
+
+	static bool IsEnabled();
+	static void GetCounts(Counts& outCounts);
+	// Lower the peak to the current live bytes, starting a new interval.
+	static void ResetPeak();
+};
+
+#endif // _ALLOCATION_TRACKER_H_
@@ -0,0 +1,316 @@
+#include "BatchRunner.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include "Serialization.h"
+#include "MeshWriter.h"
+
+// Rough peak memory of a triangulation per polygon point, with the loaded outlines and the output. The Seidel
+// engine needs about this much, the sweep less.
+static const int_t BytesPerPoint = 1024;
+// Before a file is loaded its memory is guessed from its size. Text files take about 20 bytes per point.
+static const int_t BytesPerFileByte = BytesPerPoint / 16;
+
+void BatchRunner::Run(const std::vector<std::string>& polyFiles, const Options& options, std::vector<FileResult>& outResults)
+{
+	outResults.assign(polyFiles.size(), FileResult());
+
+	// Files that would write to the same output names as an earlier file, such as a.poly and a.bpoly, fail
+	// instead of overwriting its results.
+	std::vector<index_t> fileIndices;
+	std::unordered_map<std::string, index_t> outputOwners;
+	for (index_t i = 0; i < polyFiles.size(); ++i)
+	{
+		auto owner = outputOwners.emplace(GetOutputStem(polyFiles[i], options), i);
+		if (owner.second)
+		{
+			fileIndices.push_back(i);
+			continue;
+		}
+
+		outResults[i].fileName = polyFiles[i];
+		outResults[i].errDesc = "Output names collide with " + polyFiles[owner.first->second] + ".";
+	}
+
+	index_t numFiles = fileIndices.size();
+	std::vector<int_t> estimates(numFiles);
+	for (index_t i = 0; i < numFiles; ++i)
+		estimates[i] = EstimateMemory(polyFiles[fileIndices[i]]);
+
+	int_t numThreads = (options.numThreads > 0) ? options.numThreads : std::max<int_t>(std::thread::hardware_concurrency(), 1);
+	numThreads = std::max<int_t>(std::min<int_t>(numThreads, numFiles), 1);
+
+	std::mutex mutex;
+	std::condition_variable budgetFreed;
+	index_t nextFile = 0;
+	int_t inFlightBytes = 0;
+	int_t numInFlight = 0;
+
+	auto worker = [&]() {
+		std::unique_ptr<Triangulator> triangulator;
+
+		while (true)
+		{
+			index_t fileIndex;
+			int_t reservedBytes;
+			{
+				// Files start in order, a file that doesn't fit waits until enough of the others have finished.
+				std::unique_lock<std::mutex> lock(mutex);
+				budgetFreed.wait(lock, [&]() {
+					return nextFile >= numFiles || numInFlight == 0 || inFlightBytes + estimates[nextFile] <= options.memoryBudget;
+				});
+
+				if (nextFile >= numFiles)
+					return;
+
+				reservedBytes = estimates[nextFile];
+				fileIndex = fileIndices[nextFile++];
+				inFlightBytes += reservedBytes;
+				++numInFlight;
+			}
+
+			// Once the number of points is known, the guess is replaced by the estimate from the points.
+			auto updateReservation = [&](int_t bytes) {
+				std::lock_guard<std::mutex> lock(mutex);
+				inFlightBytes += bytes - reservedBytes;
+				reservedBytes = bytes;
+			};
+
+			// A failed allocation fails this file only, the triangulator may be left half set up.
+			try
+			{
+				ProcessFile(polyFiles[fileIndex], options, triangulator, outResults[fileIndex], updateReservation);
+			}
+			catch (const std::exception& e)
+			{
+				outResults[fileIndex].success = false;
+				outResults[fileIndex].errDesc = e.what();
+				triangulator.reset();
+			}
+
+			// The buffers of a warm triangulator keep the size of the largest polygon, which the budget doesn't
+			// account for once the file is done. Triangulators grown by large polygons are released.
+			if (reservedBytes > options.memoryBudget / numThreads)
+				triangulator.reset();
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				inFlightBytes -= reservedBytes;
+				--numInFlight;
+			}
+			budgetFreed.notify_all();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int_t t = 1; t < numThreads; ++t)
+		threads.emplace_back(worker);
+
+	worker();
+
+	for (auto& thread : threads)
+		thread.join();
+}
+
+void BatchRunner::ProcessFile(const std::string& polyFile, const Options& options, std::unique_ptr<Triangulator>& triangulator,
+	FileResult& result, const std::function<void(int_t)>& updateReservation)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+	auto stem = GetOutputStem(polyFile, options);
+	result.fileName = polyFile;
+
+	// The workers run in parallel already, so each file is parsed on a single thread.
+	OutlineList outlines;
+	if (!LoadPolyFile(polyFile, outlines, 1))
+	{
+		result.errDesc = "Failed to load polygon file.";
+		return;
+	}
+
+	for (const auto& outl : outlines)
+		result.numPoints += outl.size();
+
+	updateReservation(result.numPoints * BytesPerPoint);
+
+	if (triangulator)
+		triangulator->SetPolygon(outlines);
+	else
+		triangulator = CreateTriangulator(options.type, outlines);
+
+	// Nothing is written for a polygon that can't be triangulated.
+	if (!triangulator->IsSimplePolygon())
+	{
+		result.errDesc = "Not a simple polygon.";
+		return;
+	}
+
+	if (options.format == OutputFormat::Text || options.format == OutputFormat::Binary)
+	{
+		bool binary = (options.format == OutputFormat::Binary);
+		std::string indicesFile = stem + (binary ? ".btind" : ".tind");
+		std::string pointsFile = stem + (binary ? ".btpts" : ".tpts");
+
+		IndexList triangleIndices;
+		if (!triangulator->Triangulate(Triangulator::FillRule::EvenOdd, Triangulator::Winding::CW, triangleIndices))
+		{
+			result.errDesc = "Failed to triangulate.";
+			return;
+		}
+
+		result.numTriangles = triangleIndices.size() / 3;
+
+		if (!SaveTriangleIndices(indicesFile, triangleIndices) || !SaveTrianglePoints(pointsFile, triangleIndices, triangulator->GetPointCoords()))
+		{
+			std::error_code ec;
+			std::filesystem::remove(indicesFile, ec);
+			std::filesystem::remove(pointsFile, ec);
+			result.errDesc = "Failed to write " + stem + ".";
+			return;
+		}
+	}
+	else
+	{
+		MeshFormat meshFormat = (options.format == OutputFormat::OBJ) ? MeshFormat::OBJ : (options.format == OutputFormat::PLY) ? MeshFormat::PLY : MeshFormat::STL;
+		std::string meshFile = stem + "." + GetMeshFormatName(meshFormat);
+
+		// Counter-clockwise, so that the faces point up.
+		// The triangles are streamed into the file, so a failed triangulation leaves a partial mesh behind to remove.
+		MeshWriter writer;
+		bool opened = writer.Open(meshFile, meshFormat, triangulator->GetPointCoords());
+		bool triangulated = opened && triangulator->Triangulate(Triangulator::FillRule::EvenOdd, Triangulator::Winding::CCW, writer);
+		bool closed = writer.Close();
+
+		if (!triangulated || !closed)
+		{
+			std::error_code ec;
+			std::filesystem::remove(meshFile, ec);
+			result.errDesc = (opened && !triangulated) ? "Failed to triangulate." : "Failed to write " + meshFile + ".";
+			return;
+		}
+
+		result.numTriangles = writer.GetNumTriangles();
+	}
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+	result.timeMS = std::chrono::duration<double, std::chrono::milliseconds::period>(endTime - startTime).count();
+	result.success = true;
+}
+
+std::string BatchRunner::GetOutputStem(const std::string& polyFile, const Options& options)
+{
+	return (std::filesystem::path(options.outputDirectory) / std::filesystem::path(polyFile).stem()).string();
+}
+
+int_t BatchRunner::EstimateMemory(const std::string& polyFile)
+{
+	std::error_code ec;
+	auto fileSize = std::filesystem::file_size(polyFile, ec);
+
+	return ec ? 0 : static_cast<int_t>(fileSize) * BytesPerFileByte;
+}
+
+bool BatchRunner::ListInputFiles(const std::string& path, std::vector<std::string>& outPolyFiles)
+{
+	if (std::filesystem::path(path).extension() != ".txt")
+		return ListPolyFiles(path, outPolyFiles);
+
+	std::ifstream file(path);
+	if (!file.is_open())
+		return false;
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+
+		if (!line.empty())
+			outPolyFiles.push_back(line);
+	}
+
+	return true;
+}
+
+const char* BatchRunner::GetOutputFormatName(OutputFormat format)
+{
+	switch (format)
+	{
+	case OutputFormat::Text:
+		return "tind";
+	case OutputFormat::Binary:
+		return "btind";
+	case OutputFormat::OBJ:
+		return "obj";
+	case OutputFormat::PLY:
+		return "ply";
+	case OutputFormat::STL:
+		return "stl";
+	}
+
+	return "";
+}
+
+bool BatchRunner::ParseOutputFormat(const std::string& name, OutputFormat& format)
+{
+	for (auto f : { OutputFormat::Text, OutputFormat::Binary, OutputFormat::OBJ, OutputFormat::PLY, OutputFormat::STL })
+	{
+		if (name == GetOutputFormatName(f))
+		{
+			format = f;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool BatchRunner::SaveJSON(const std::string& fileName, const std::vector<FileResult>& results)
+{
+	std::ofstream file(fileName);
+	if (!file.is_open())
+		return false;
+
+	file.precision(9);
+	file << "{\n\t\"files\": [\n";
+
+	for (index_t i = 0; i < results.size(); ++i)
+	{
+		const auto& result = results[i];
+
+		file << "\t\t{ "
+			<< "\"file\": \"" << EscapeJSON(result.fileName) << "\", "
+			<< "\"success\": " << (result.success ? "true" : "false") << ", "
+			<< "\"error\": \"" << EscapeJSON(result.errDesc) << "\", "
+			<< "\"points\": " << result.numPoints << ", "
+			<< "\"triangles\": " << result.numTriangles << ", "
+			<< "\"time_ms\": " << result.timeMS << " }"
+			<< ((i + 1 < results.size()) ? "," : "") << "\n";
+	}
+
+	file << "\t]\n}\n";
+
+	return file.good();
+}
+
+bool BatchRunner::SaveCSV(const std::string& fileName, const std::vector<FileResult>& results)
+{
+	std::ofstream file(fileName);
+	if (!file.is_open())
+		return false;
+
+	file.precision(9);
+	file << "file,success,error,points,triangles,time_ms\n";
+
+	for (const auto& result : results)
+	{
+		file << QuoteCSV(result.fileName) << "," << (result.success ? 1 : 0) << "," << QuoteCSV(result.errDesc) << ","
+			<< result.numPoints << "," << result.numTriangles << "," << result.timeMS << "\n";
+	}
+
+	return file.good();
+}
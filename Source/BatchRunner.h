@@ -0,0 +1,65 @@
+#ifndef _BATCH_RUNNER_H_
+#define _BATCH_RUNNER_H_
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include "Triangulator.h"
+
+
+// Triangulates many polygon files on a pool of worker threads and writes each result next to the others in
+// the output directory. Every worker keeps one triangulator and reuses it for its files. A file is started only
+// if the estimated memory of the files in flight stays within the budget, except when no other file is in flight.
+class BatchRunner
+{
+public:
+	enum class OutputFormat
+	{
+		Text,		// .tind and .tpts
+		Binary,		// .btind and .btpts
+		OBJ,
+		PLY,
+		STL,
+	};
+
+	struct Options
+	{
+		TriangulatorType type = TriangulatorType::Seidel;
+		OutputFormat format = OutputFormat::Text;
+		std::string outputDirectory;
+		int_t numThreads = 0;				// 0 uses all hardware threads.
+		int_t memoryBudget = int_t(1) << 30;	// Bytes.
+	};
+
+	struct FileResult
+	{
+		std::string fileName;
+		bool success = false;
+		std::string errDesc;
+		int_t numPoints = 0;
+		int_t numTriangles = 0;
+		double timeMS = 0.0;	// Load, triangulation and output.
+	};
+
+	// One result for each file, in the order of the files. A file whose outputs would have the same names as those
+	// of an earlier file fails.
+	static void Run(const std::vector<std::string>& polyFiles, const Options& options, std::vector<FileResult>& outResults);
+
+	// A directory yields its polygon files, a .txt file the paths it lists one per line, any other file itself.
+	static bool ListInputFiles(const std::string& path, std::vector<std::string>& outPolyFiles);
+
+	static const char* GetOutputFormatName(OutputFormat format);
+	static bool ParseOutputFormat(const std::string& name, OutputFormat& format);
+	static bool SaveJSON(const std::string& fileName, const std::vector<FileResult>& results);
+	static bool SaveCSV(const std::string& fileName, const std::vector<FileResult>& results);
+
+private:
+	static void ProcessFile(const std::string& polyFile, const Options& options, std::unique_ptr<Triangulator>& triangulator,
+		FileResult& result, const std::function<void(int_t)>& updateReservation);
+	// Output directory and file name without the extension, which the output format adds.
+	static std::string GetOutputStem(const std::string& polyFile, const Options& options);
+	static int_t EstimateMemory(const std::string& polyFile);
+};
+
+#endif // _BATCH_RUNNER_H_
@@ -0,0 +1,252 @@
+#include "BatchTriangulator.h"
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+
+BatchTriangulator::BatchTriangulator(TriangulatorType type, Triangulator::FillRule fillRule, Triangulator::Winding winding, int_t maxCacheBytes)
+	: _type(type), _fillRule(fillRule), _winding(winding), _maxCacheBytes(maxCacheBytes)
+{
+}
+
+bool BatchTriangulator::Triangulate(const OutlineList& outlines, IndexList& outTriangleIndices)
+{
+	outTriangleIndices.clear();
+	++_statistics.numPolygons;
+
+	std::uint64_t hash = Canonicalize(outlines);
+	auto shapeIt = FindShape(hash);
+
+	if (shapeIt != _shapes.end())
+	{
+		++_statistics.numCacheHits;
+		_shapes.splice(_shapes.begin(), _shapes, shapeIt);
+	}
+	else
+	{
+		// Not seen before, run the triangulator and store its result in canonical point order.
+		auto triangulator = CreateTriangulator(_type, outlines);
+
+		Shape shape;
+		if (!triangulator->Triangulate(_fillRule, _winding, shape.triangleIndices))
+		{
+			// Not cached, a failed shape has no triangles to check against a nearby polygon that is simple.
+			++_statistics.numFailed;
+			return false;
+		}
+
+		shape.hash = hash;
+		shape.outlineSizes = _outlineSizes;
+		shape.points = _canonicalPoints;
+		shape.maxAbsCoord = _maxAbsCoord;
+
+		for (auto& index : shape.triangleIndices)
+			index = _originalToCanonical[index];
+
+		_cacheBytes += GetShapeBytes(shape);
+		_shapes.push_front(std::move(shape));
+		_shapeIndices.emplace(hash, _shapes.begin());
+		++_statistics.numUniqueShapes;
+	}
+
+	const Shape& shape = _shapes.front();
+	outTriangleIndices.resize(shape.triangleIndices.size());
+	for (index_t i = 0; i < shape.triangleIndices.size(); ++i)
+		outTriangleIndices[i] = _canonicalToOriginal[shape.triangleIndices[i]];
+
+	// Trimmed only after the output is written, a shape larger than the whole cache is dropped right away.
+	TrimCache();
+
+	return true;
+}
+
+void BatchTriangulator::ResetStatistics()
+{
+	_statistics = { };
+}
+
+void BatchTriangulator::ClearCache()
+{
+	_shapes.clear();
+	_shapeIndices.clear();
+	_cacheBytes = 0;
+}
+
+// Drop the least recently used shapes until the cache is within its size.
+void BatchTriangulator::TrimCache()
+{
+	while (_cacheBytes > _maxCacheBytes && !_shapes.empty())
+	{
+		auto shapeIt = std::prev(_shapes.end());
+		auto range = _shapeIndices.equal_range(shapeIt->hash);
+
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (it->second == shapeIt)
+			{
+				_shapeIndices.erase(it);
+				break;
+			}
+		}
+
+		_cacheBytes -= GetShapeBytes(*shapeIt);
+		_shapes.erase(shapeIt);
+		++_statistics.numEvictedShapes;
+	}
+}
+
+// Memory held by a cached shape, including the list and lookup entries.
+int_t BatchTriangulator::GetShapeBytes(const Shape& shape)
+{
+	const int_t EntryBytes = 64;
+
+	return sizeof(Shape) + EntryBytes +
+		shape.outlineSizes.capacity() * sizeof(index_t) +
+		shape.points.capacity() * sizeof(math3d::vec2f) +
+		shape.triangleIndices.capacity() * sizeof(index_t);
+}
+
+// Build the canonical form of the polygon and return its hash.
+std::uint64_t BatchTriangulator::Canonicalize(const OutlineList& outlines)
+{
+	_outlineSizes.clear();
+	_canonicalPoints.clear();
+	_canonicalToOriginal.clear();
+	_maxAbsCoord = 0.0f;
+
+	for (const auto& outl : outlines)
+	{
+		for (const auto& pt : outl)
+			_maxAbsCoord = std::max({ _maxAbsCoord, std::abs(pt.x), std::abs(pt.y) });
+	}
+
+	float tolerance = Tolerance(_maxAbsCoord);
+	math3d::vec2f origin = { 0.0f, 0.0f };
+	index_t firstPtIndex = 0;
+
+	for (index_t outlIndex = 0; outlIndex < outlines.size(); ++outlIndex)
+	{
+		const auto& outl = outlines[outlIndex];
+		index_t n = outl.size();
+
+		// Start at the leftmost of the lowest vertices. Vertices within twice the tolerance of the lowest one count
+		// as equally low, otherwise rounding would pick different starts on horizontal edges.
+		float minY = std::numeric_limits<float>::max();
+		for (const auto& pt : outl)
+			minY = std::min(minY, pt.y);
+
+		index_t start = -1;
+		for (index_t i = 0; i < n; ++i)
+		{
+			if (outl[i].y <= minY + 2.0f * tolerance && (start < 0 || outl[i].x < outl[start].x))
+				start = i;
+		}
+
+		if (outlIndex == 0 && n > 0)
+			origin = outl[start];
+
+		_outlineSizes.push_back(n);
+
+		for (index_t i = 0; i < n; ++i)
+		{
+			index_t ptIndex = (start + i) % n;
+			_canonicalPoints.push_back(outl[ptIndex] - origin);
+			_canonicalToOriginal.push_back(firstPtIndex + ptIndex);
+		}
+
+		firstPtIndex += n;
+	}
+
+	_originalToCanonical.resize(_canonicalToOriginal.size());
+	for (index_t i = 0; i < _canonicalToOriginal.size(); ++i)
+		_originalToCanonical[_canonicalToOriginal[i]] = i;
+
+	// FNV-1a.
+	std::uint64_t hash = 14695981039346656037ull;
+	auto hashValue = [&hash](std::uint64_t value) {
+		for (int i = 0; i < 8; ++i)
+		{
+			hash ^= (value >> (i * 8)) & 0xff;
+			hash *= 1099511628211ull;
+		}
+	};
+
+	for (index_t n : _outlineSizes)
+		hashValue(n);
+
+	// Only the first few points after the origin go into the hash, snapped to a grid of about a tenth of the
+	// shape's size. It depends only on the shape, not on where it is, and it is much coarser than the comparison
+	// tolerance, so that nearly equal shapes almost always land in the same bucket.
+	float extent = 0.0f;
+	for (const auto& pt : _canonicalPoints)
+		extent = std::max({ extent, std::abs(pt.x), std::abs(pt.y) });
+
+	int extentExp;
+	std::frexp(extent, &extentExp);
+	double cellSize = std::ldexp(1.0, extentExp - 4);
+
+	for (index_t i = 1; i < std::min<index_t>(_canonicalPoints.size(), 5); ++i)
+	{
+		hashValue(static_cast<std::uint64_t>(static_cast<std::int64_t>(std::floor(_canonicalPoints[i].x / cellSize))));
+		hashValue(static_cast<std::uint64_t>(static_cast<std::int64_t>(std::floor(_canonicalPoints[i].y / cellSize))));
+	}
+
+	return hash;
+}
+
+// Returns the cached shape that matches the current canonical form, or the end of the list.
+BatchTriangulator::ShapeList::iterator BatchTriangulator::FindShape(std::uint64_t hash)
+{
+	auto range = _shapeIndices.equal_range(hash);
+
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		const Shape& shape = *it->second;
+		if (shape.outlineSizes != _outlineSizes)
+			continue;
+
+		float tolerance = Tolerance(std::max(shape.maxAbsCoord, _maxAbsCoord));
+		bool equal = true;
+
+		for (index_t i = 0; i < _canonicalPoints.size() && equal; ++i)
+		{
+			equal = std::abs(shape.points[i].x - _canonicalPoints[i].x) <= tolerance &&
+				std::abs(shape.points[i].y - _canonicalPoints[i].y) <= tolerance;
+		}
+
+		if (equal && IsPatternValid(shape))
+			return it->second;
+	}
+
+	return _shapes.end();
+}
+
+// Allow for rounding of the original coordinates and of the translation, about 2-4 float ulps.
+float BatchTriangulator::Tolerance(float maxAbsCoord)
+{
+	return maxAbsCoord * std::ldexp(1.0f, -21);
+}
+
+// The cached triangles fit the current polygon if none of them has flipped or collapsed.
+bool BatchTriangulator::IsPatternValid(const Shape& shape) const
+{
+	auto orientation = [](const std::vector<math3d::vec2f>& pts, index_t i1, index_t i2, index_t i3) {
+		double ax = pts[i1].x, ay = pts[i1].y;
+		return (pts[i2].x - ax) * (pts[i3].y - ay) - (pts[i2].y - ay) * (pts[i3].x - ax);
+	};
+
+	for (index_t i = 0; i < shape.triangleIndices.size(); i += 3)
+	{
+		index_t i1 = shape.triangleIndices[i];
+		index_t i2 = shape.triangleIndices[i + 1];
+		index_t i3 = shape.triangleIndices[i + 2];
+		double cachedOrient = orientation(shape.points, i1, i2, i3);
+		double orient = orientation(_canonicalPoints, i1, i2, i3);
+
+		if (orient == 0.0 || (orient > 0.0) != (cachedOrient > 0.0))
+			return false;
+	}
+
+	return true;
+}
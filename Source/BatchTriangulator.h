@@ -0,0 +1,83 @@
+#ifndef _BATCH_TRIANGULATOR_H_
+#define _BATCH_TRIANGULATOR_H_
+
+#include <vector>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include "Triangulator.h"
+
+
+// Triangulates a sequence of polygons, reusing the result for polygons that are congruent up to translation
+// with one seen before. Each polygon is reduced to a canonical form: every outline starts at its lowest vertex and
+// all points are relative to the start of the first outline. Outlines have to come in the same order to match.
+// Translated float coordinates rarely match exactly, so canonical forms are compared with a tolerance of a few
+// units in the last place, and a reused triangle pattern is accepted only if no triangle changes orientation.
+// The cache is limited to a number of bytes. When it is full, the shapes used least recently are dropped.
+class BatchTriangulator
+{
+public:
+	// Counted over all polygons since construction or ResetStatistics(), independent of the cache contents.
+	struct Statistics
+	{
+		int_t numPolygons = 0;
+		int_t numCacheHits = 0;
+		int_t numUniqueShapes = 0;	// Shapes that had to be triangulated, including ones evicted and seen again.
+		int_t numEvictedShapes = 0;
+		int_t numFailed = 0;
+
+		double HitRate() const { return (numPolygons > 0) ? static_cast<double>(numCacheHits) / numPolygons : 0.0; }
+	};
+
+	static const int_t DefaultMaxCacheBytes = int_t(256) << 20;
+
+	BatchTriangulator(TriangulatorType type, Triangulator::FillRule fillRule, Triangulator::Winding winding, int_t maxCacheBytes = DefaultMaxCacheBytes);
+
+	// Returns false if the polygon is not simple.
+	bool Triangulate(const OutlineList& outlines, IndexList& outTriangleIndices);
+	const Statistics& GetStatistics() const { return _statistics; }
+	void ResetStatistics();
+
+	int_t GetCacheBytes() const { return _cacheBytes; }
+	void ClearCache();
+
+private:
+	struct Shape
+	{
+		std::uint64_t hash;
+		IndexList outlineSizes;
+		std::vector<math3d::vec2f> points;
+		IndexList triangleIndices;	// Indices into the canonical point order.
+		float maxAbsCoord;
+	};
+
+	using ShapeList = std::list<Shape>;
+
+	std::uint64_t Canonicalize(const OutlineList& outlines);
+	ShapeList::iterator FindShape(std::uint64_t hash);
+	bool IsPatternValid(const Shape& shape) const;
+	void TrimCache();
+
+	static float Tolerance(float maxAbsCoord);
+	static int_t GetShapeBytes(const Shape& shape);
+
+	TriangulatorType _type;
+	Triangulator::FillRule _fillRule;
+	Triangulator::Winding _winding;
+	Statistics _statistics;
+
+	// Most recently used shapes first.
+	ShapeList _shapes;
+	std::unordered_multimap<std::uint64_t, ShapeList::iterator> _shapeIndices;
+	int_t _maxCacheBytes;
+	int_t _cacheBytes = 0;
+
+	// Canonical form of the current polygon.
+	IndexList _outlineSizes;
+	std::vector<math3d::vec2f> _canonicalPoints;
+	float _maxAbsCoord;
+	IndexList _canonicalToOriginal;
+	IndexList _originalToCanonical;
+};
+
+#endif // _BATCH_TRIANGULATOR_H_
@@ -1,60 +1,975 @@
 #include "Benchmark.h"
-#include <chrono>
-#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <thread>
+#include <atomic>
 #include "Serialization.h"
+#include "BinaryPolyFile.h"
+#include "SeidelTriangulator.h"
 
-bool Benchmark::LoadPolygon(const char* polygonFileName, std::string& errDesc)
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+bool Benchmark::LoadPolygon(const char* polygonFileName, TriangulatorType type, std::string& errDesc)
 {
 	OutlineList outlines;
 	if (!LoadPolyFile(polygonFileName, outlines))
 	{
+		_outlines.clear();
 		errDesc = "Failed to load polygon file.";
 		return false;
 	}
 
-	_triangulator = std::make_unique<SeidelTriangulator>(outlines);
-	if (!_triangulator->IsSimplePolygon())
+	return SetPolygon(std::move(outlines), polygonFileName, type, errDesc);
+}
+
+bool Benchmark::SetPolygon(OutlineList outlines, const std::string& name, TriangulatorType type, std::string& errDesc)
+{
+	_outlines = std::move(outlines);
+	_numPoints = 0;
+
+	auto triangulator = CreateTriangulator(type, _outlines);
+	if (!triangulator->IsSimplePolygon())
 	{
-		_triangulator.reset();
+		_outlines.clear();
 		errDesc = "Not a simple polygon.";
 		return false;
 	}
 
+	_fileName = name;
+	_type = type;
+	_numPoints = triangulator->GetPointCoords().size();
+
 	return true;
 }
 
+void Benchmark::SetSegmentOrder(SegmentOrder order, std::uint32_t seed)
+{
+	_segmentOrder = order;
+	_seed = seed;
+}
+
 void Benchmark::Run(int numIterations, Statistics& statistics)
 {
-	if (numIterations <= 0 || _triangulator == nullptr)
-	{
-		statistics = { };
+	statistics = { };
+
+	if (numIterations <= 0 || _outlines.empty())
 		return;
-	}
 
-	SeidelTriangulator::TrapezoidationInfo trapInfo { };
-	SeidelTriangulator::TriangulationInfo triangInfo { };
 	IndexList triangleIndices;
-	IndexList diagonalIndices;
-	std::vector<IndexList> monotoneChains;
+	PhaseTimer phaseTimer;
+	std::vector<double> phaseSamples[NumPhases];
+	std::vector<double> iterationSamples;
+	std::vector<double> algorithmSamples;
+	std::vector<double> maxDepthSamples;
+	std::vector<double> averageDepthSamples;
+	std::vector<double> numNodesSamples;
+	std::vector<double> treeBytesSamples;
+	std::vector<double> numFramesSamples;
+	std::vector<double> frameSamples;
+	PerfCounters counters;
+	double phaseCounts[NumPhases][PerfCounters::NumCounters] = { };
+	double iterationCounts[PerfCounters::NumCounters] = { };
+	index_t phaseIterations[NumPhases] = { };
+	int_t phaseAllocations[NumPhases] = { };
+	int_t phaseAllocatedBytes[NumPhases] = { };
+	int_t iterationAllocations = 0;
+	int_t iterationAllocatedBytes = 0;
+	int_t phasePeakLiveBytes[NumPhases] = { };
+	int_t iterationPeakLiveBytes = 0;
 
-	statistics.numOutlines = _triangulator->GetOutlinesWinding().size();
-	statistics.numPoints = _triangulator->GetPointCoords().size();
-	statistics.averageTimeMS = 0.0f;
+	statistics.fileName = _fileName;
+	statistics.type = _type;
+	statistics.numIterations = numIterations;
+	statistics.numOutlines = _outlines.size();
+	statistics.numPoints = _numPoints;
+	statistics.segmentOrder = _segmentOrder;
+	statistics.seed = _seed;
 
-	auto startTime = std::chrono::high_resolution_clock::now();
+	// Without counters the benchmark still runs, only the counts are missing.
+	if (_collectCounters && counters.Open())
+	{
+		statistics.countersMeasured = true;
+		for (index_t c = 0; c < PerfCounters::NumCounters; ++c)
+			statistics.counterAvailable[c] = counters.IsAvailable(static_cast<PerfCounters::Counter>(c));
+
+		phaseTimer.counters = &counters;
+	}
+
+	statistics.allocationsMeasured = _trackAllocations && AllocationTracker::IsEnabled();
+	phaseTimer.trackAllocations = statistics.allocationsMeasured;
+	phaseTimer.trace = _traceRecorder;
+
+	Triangulator::SetPhaseListener(&phaseTimer);
 
 	for (int i = 0; i < numIterations; ++i)
 	{
+		phaseTimer.Reset();
+		if (_traceRecorder != nullptr)
+			_traceRecorder->Begin("iteration", i);
+
+		PerfCounters::Values iterStartCounts;
+		if (statistics.countersMeasured)
+			counters.Read(iterStartCounts);
+
+		AllocationTracker::Counts iterStartAllocations;
+		if (statistics.allocationsMeasured)
+		{
+			AllocationTracker::GetCounts(iterStartAllocations);
+			AllocationTracker::ResetPeak();
+		}
+
 		auto iterStartTime = std::chrono::high_resolution_clock::now();
 
-		_triangulator->BuildTrapezoidTree(trapInfo);
-		_triangulator->Triangulate(triangInfo, triangleIndices, diagonalIndices, monotoneChains);
+		auto triangulator = CreateTriangulator(_type, _outlines);
+		auto seidel = (_type == TriangulatorType::Seidel) ? static_cast<SeidelTriangulator*>(triangulator.get()) : nullptr;
+		if (seidel != nullptr)
+			seidel->SetRandomSeed((_segmentOrder == SegmentOrder::Fixed) ? _seed : _seed + static_cast<std::uint32_t>(i));
+
+		if (seidel != nullptr && _frameBudgetMS >= 0.0)
+		{
+			// Each Step() call stands for the share of one frame.
+			SeidelTriangulator::StepBudget budget;
+			budget.maxTimeMS = _frameBudgetMS;
+			seidel->BeginSteps(Triangulator::FillRule::EvenOdd, Triangulator::Winding::CW);
+
+			index_t numFrames = 0;
+			while (seidel->GetStepPhase() != SeidelTriangulator::StepPhase::Idle && seidel->GetStepPhase() != SeidelTriangulator::StepPhase::Finished)
+			{
+				auto frameStartTime = std::chrono::high_resolution_clock::now();
+				seidel->Step(budget);
+				auto frameEndTime = std::chrono::high_resolution_clock::now();
+				frameSamples.push_back(std::chrono::duration<double, std::chrono::milliseconds::period>(frameEndTime - frameStartTime).count());
+				++numFrames;
+			}
+
+			numFramesSamples.push_back(static_cast<double>(numFrames));
+			triangleIndices = seidel->GetStepTriangleIndices();
+		}
+		else
+		{
+			triangulator->Triangulate(Triangulator::FillRule::EvenOdd, Triangulator::Winding::CW, triangleIndices);
+		}
 
 		auto iterEndTime = std::chrono::high_resolution_clock::now();
-		auto time = std::chrono::duration<double, std::chrono::milliseconds::period>(iterEndTime - iterStartTime).count();
-		statistics.averageTimeMS += time / numIterations;
+		double iterationMS = std::chrono::duration<double, std::chrono::milliseconds::period>(iterEndTime - iterStartTime).count();
+		iterationSamples.push_back(iterationMS);
+
+		index_t validationPhase = static_cast<index_t>(Triangulator::Phase::Validation);
+		algorithmSamples.push_back(iterationMS - (phaseTimer.measured[validationPhase] ? phaseTimer.timesMS[validationPhase] : 0.0));
+
+		if (statistics.countersMeasured)
+		{
+			PerfCounters::Values iterEndCounts;
+			counters.Read(iterEndCounts);
+			for (index_t c = 0; c < PerfCounters::NumCounters; ++c)
+				iterationCounts[c] += static_cast<double>(iterEndCounts[c] - iterStartCounts[c]);
+		}
+
+		if (statistics.allocationsMeasured)
+		{
+			AllocationTracker::Counts iterEndAllocations;
+			AllocationTracker::GetCounts(iterEndAllocations);
+			int_t maxLiveBytes = std::max(phaseTimer.maxLiveBytes, iterEndAllocations.peakLiveBytes);
+
+			iterationAllocations += iterEndAllocations.numAllocations - iterStartAllocations.numAllocations;
+			iterationAllocatedBytes += iterEndAllocations.numBytes - iterStartAllocations.numBytes;
+			iterationPeakLiveBytes = std::max(iterationPeakLiveBytes, maxLiveBytes - iterStartAllocations.liveBytes);
+		}
+
+		if (_traceRecorder != nullptr)
+			_traceRecorder->End("iteration", i);
+
+		// Measured outside of the timed part.
+		if (seidel != nullptr && seidel->GetTreeRootNode() != nullptr)
+		{
+			SeidelTriangulator::TreeStatistics treeStats;
+			seidel->GetTreeStatistics(treeStats);
+			maxDepthSamples.push_back(static_cast<double>(treeStats.maxDepth));
+			averageDepthSamples.push_back(treeStats.averageDepth);
+			numNodesSamples.push_back(static_cast<double>(treeStats.numNodes));
+			treeBytesSamples.push_back(static_cast<double>(treeStats.numBytes));
+		}
+
+		if (seidel != nullptr && SeidelTriangulator::HasStatistics())
+		{
+			const auto& engineStats = seidel->GetStatistics();
+			auto& total = statistics.engine;
+			statistics.engineMeasured = true;
+			total.numPointLocations += engineStats.numPointLocations;
+			total.numNodesVisited += engineStats.numNodesVisited;
+			total.maxLocationDepth = std::max(total.maxLocationDepth, engineStats.maxLocationDepth);
+			total.numTrapezoidSplits += engineStats.numTrapezoidSplits;
+			total.numMerges += engineStats.numMerges;
+			total.numPredicates += engineStats.numPredicates;
+			total.numMonotoneChains += engineStats.numMonotoneChains;
+			for (index_t b = 0; b < SeidelTriangulator::Statistics::NumChainLengthBuckets; ++b)
+				total.chainLengthHistogram[b] += engineStats.chainLengthHistogram[b];
+		}
+
+		for (index_t p = 0; p < NumPhases; ++p)
+		{
+			if (phaseTimer.measured[p])
+			{
+				phaseSamples[p].push_back(phaseTimer.timesMS[p]);
+				++phaseIterations[p];
+				for (index_t c = 0; c < PerfCounters::NumCounters; ++c)
+					phaseCounts[p][c] += static_cast<double>(phaseTimer.counts[p][c]);
+
+				phaseAllocations[p] += phaseTimer.numAllocations[p];
+				phaseAllocatedBytes[p] += phaseTimer.allocatedBytes[p];
+				phasePeakLiveBytes[p] = std::max(phasePeakLiveBytes[p], phaseTimer.peakLiveBytes[p]);
+			}
+		}
+	}
+
+	Triangulator::SetPhaseListener(nullptr);
+
+	for (index_t p = 0; p < NumPhases; ++p)
+		CalculatePhaseStatistics(phaseSamples[p], statistics.phases[p]);
+
+	CalculatePhaseStatistics(iterationSamples, statistics.iteration);
+	CalculatePhaseStatistics(algorithmSamples, statistics.algorithm);
+
+	if (statistics.allocationsMeasured)
+	{
+		for (index_t p = 0; p < NumPhases; ++p)
+		{
+			if (phaseIterations[p] > 0)
+			{
+				statistics.phases[p].numAllocations = static_cast<double>(phaseAllocations[p]) / phaseIterations[p];
+				statistics.phases[p].allocatedBytes = static_cast<double>(phaseAllocatedBytes[p]) / phaseIterations[p];
+				statistics.phases[p].peakLiveBytes = phasePeakLiveBytes[p];
+			}
+		}
+
+		statistics.iteration.numAllocations = static_cast<double>(iterationAllocations) / numIterations;
+		statistics.iteration.allocatedBytes = static_cast<double>(iterationAllocatedBytes) / numIterations;
+		statistics.iteration.peakLiveBytes = iterationPeakLiveBytes;
+	}
+
+	if (statistics.countersMeasured)
+	{
+		for (index_t c = 0; c < PerfCounters::NumCounters; ++c)
+		{
+			for (index_t p = 0; p < NumPhases; ++p)
+			{
+				if (phaseIterations[p] > 0)
+					statistics.phases[p].counts[c] = phaseCounts[p][c] / phaseIterations[p];
+			}
+
+			statistics.iteration.counts[c] = iterationCounts[c] / numIterations;
+		}
+	}
+
+	if (!maxDepthSamples.empty())
+	{
+		statistics.tree.measured = true;
+		CalculateValueStatistics(maxDepthSamples, statistics.tree.maxDepth);
+		CalculateValueStatistics(averageDepthSamples, statistics.tree.averageDepth);
+		CalculateValueStatistics(numNodesSamples, statistics.tree.numNodes);
+		CalculateValueStatistics(treeBytesSamples, statistics.tree.numBytes);
+	}
+
+	if (!numFramesSamples.empty())
+	{
+		statistics.framesMeasured = true;
+		CalculateValueStatistics(numFramesSamples, statistics.numFrames);
+		CalculatePhaseStatistics(frameSamples, statistics.frames);
 	}
 
+	statistics.numTriangles = triangleIndices.size() / 3;
+	statistics.outputBytes = triangleIndices.size() * sizeof(index_t);
+	statistics.averageTimeMS = statistics.iteration.meanMS;
+	statistics.totalTimeMS = statistics.iteration.meanMS * numIterations;
+}
+
+void Benchmark::RunThroughput(const std::vector<OutlineList>& corpus, TriangulatorType type, int_t numThreads, int_t numRounds, ThroughputStatistics& statistics,
+	std::vector<TraceRecorder>* traceRecorders)
+{
+	statistics = { };
+	statistics.type = type;
+	statistics.numThreads = numThreads;
+	statistics.numRounds = numRounds;
+
+	if (numThreads <= 0 || numRounds <= 0 || corpus.empty())
+		return;
+
+	std::atomic<int_t> numReady { 0 };
+	std::atomic<bool> start { false };
+	std::vector<int_t> numPolygons(numThreads, 0);
+	std::vector<int_t> numVertices(numThreads, 0);
+	std::vector<std::thread> threads;
+
+	auto worker = [&](index_t threadIndex) {
+		// The copy is made by the thread itself, so that its memory comes from the thread's own allocations.
+		std::vector<OutlineList> ownCorpus = corpus;
+		IndexList triangleIndices;
+		int_t threadPolygons = 0;
+		int_t threadVertices = 0;
+
+		TraceRecorder* trace = (traceRecorders != nullptr) ? &(*traceRecorders)[threadIndex] : nullptr;
+		Triangulator::SetPhaseListener(trace);
+
+		++numReady;
+		while (!start.load(std::memory_order_acquire))
+			std::this_thread::yield();
+
+		for (int_t r = 0; r < numRounds; ++r)
+		{
+			if (trace != nullptr)
+				trace->Begin("round", r);
+
+			for (const auto& outlines : ownCorpus)
+			{
+				auto triangulator = CreateTriangulator(type, outlines);
+				if (triangulator->Triangulate(Triangulator::FillRule::EvenOdd, Triangulator::Winding::CW, triangleIndices))
+				{
+					++threadPolygons;
+					threadVertices += triangulator->GetPointCoords().size();
+				}
+			}
+
+			if (trace != nullptr)
+				trace->End("round", r);
+		}
+
+		Triangulator::SetPhaseListener(nullptr);
+
+		// Written once at the end, the neighbouring elements belong to other threads.
+		numPolygons[threadIndex] = threadPolygons;
+		numVertices[threadIndex] = threadVertices;
+	};
+
+	for (index_t t = 0; t < numThreads; ++t)
+		threads.emplace_back(worker, t);
+
+	while (numReady.load() < numThreads)
+		std::this_thread::yield();
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+	start.store(true, std::memory_order_release);
+
+	for (auto& thread : threads)
+		thread.join();
+
 	auto endTime = std::chrono::high_resolution_clock::now();
-	statistics.totalTimeMS = std::chrono::duration<double, std::chrono::milliseconds::period>(endTime - startTime).count();
+	statistics.timeMS = std::chrono::duration<double, std::chrono::milliseconds::period>(endTime - startTime).count();
+
+	for (index_t t = 0; t < numThreads; ++t)
+	{
+		statistics.numPolygons += numPolygons[t];
+		statistics.numVertices += numVertices[t];
+	}
+
+	if (statistics.timeMS > 0.0)
+	{
+		statistics.polygonsPerSecond = statistics.numPolygons * 1000.0 / statistics.timeMS;
+		statistics.verticesPerSecond = statistics.numVertices * 1000.0 / statistics.timeMS;
+	}
+}
+
+bool Benchmark::RunEndToEnd(const std::string& polyFile, const std::string& outputPrefix, TriangulatorType type, int numIterations, bool dropCache,
+	bool binaryOutput, EndToEndStatistics& statistics, std::string& errDesc)
+{
+	statistics = { };
+	statistics.fileName = polyFile;
+	statistics.type = type;
+	statistics.numIterations = numIterations;
+	statistics.cacheDropped = dropCache;
+	statistics.binaryOutput = binaryOutput;
+
+	if (numIterations <= 0)
+		return true;
+
+	std::string indicesFile = outputPrefix + (binaryOutput ? ".btind" : ".tind");
+	std::string pointsFile = outputPrefix + (binaryOutput ? ".btpts" : ".tpts");
+	std::vector<double> stageSamples[NumStages];
+	std::vector<double> totalSamples;
+
+	for (int i = 0; i < numIterations; ++i)
+	{
+		if (dropCache && !DropFileCache(polyFile))
+			statistics.cacheDropped = false;
+
+		double stageTimesMS[NumStages];
+		auto stageStartTime = std::chrono::high_resolution_clock::now();
+		auto endStage = [&](Stage stage) {
+			auto stageEndTime = std::chrono::high_resolution_clock::now();
+			stageTimesMS[static_cast<index_t>(stage)] = std::chrono::duration<double, std::chrono::milliseconds::period>(stageEndTime - stageStartTime).count();
+			stageStartTime = stageEndTime;
+		};
+
+		// A .bpoly file with float coordinates is triangulated in place from the mapping, so the load stage
+		// only maps it and the pages are read during construction.
+		BinaryPolyFile binaryFile;
+		IndexList outlineOffsets;
+		OutlineList outlines;
+		bool inPlace = binaryFile.Open(polyFile) && binaryFile.GetFloatCoords() != nullptr;
+		if (inPlace)
+		{
+			outlineOffsets.assign(binaryFile.GetOutlineOffsets(), binaryFile.GetOutlineOffsets() + binaryFile.GetNumOutlines() + 1);
+		}
+		else if (!LoadPolyFile(polyFile, outlines))
+		{
+			errDesc = "Failed to load polygon file.";
+			return false;
+		}
+		endStage(Stage::Load);
+
+		auto triangulator = inPlace ?
+			CreateTriangulator(type, binaryFile.GetFloatCoords(), outlineOffsets.data(), binaryFile.GetNumOutlines()) :
+			CreateTriangulator(type, outlines);
+		endStage(Stage::Construction);
+
+		IndexList triangleIndices;
+		if (!triangulator->Triangulate(Triangulator::FillRule::EvenOdd, Triangulator::Winding::CW, triangleIndices))
+		{
+			errDesc = "Not a simple polygon.";
+			return false;
+		}
+		endStage(Stage::Triangulation);
+
+		if (!SaveTriangleIndices(indicesFile, triangleIndices))
+		{
+			errDesc = "Failed to write " + indicesFile + ".";
+			return false;
+		}
+		endStage(Stage::SaveIndices);
+
+		if (!SaveTrianglePoints(pointsFile, triangleIndices, triangulator->GetPointCoords()))
+		{
+			errDesc = "Failed to write " + pointsFile + ".";
+			return false;
+		}
+		endStage(Stage::SavePoints);
+
+		double totalMS = 0.0;
+		for (index_t st = 0; st < NumStages; ++st)
+		{
+			stageSamples[st].push_back(stageTimesMS[st]);
+			totalMS += stageTimesMS[st];
+		}
+		totalSamples.push_back(totalMS);
+
+		statistics.numPoints = triangulator->GetPointCoords().size();
+		statistics.numTriangles = triangleIndices.size() / 3;
+	}
+
+	for (index_t st = 0; st < NumStages; ++st)
+		CalculatePhaseStatistics(stageSamples[st], statistics.stages[st]);
+
+	CalculatePhaseStatistics(totalSamples, statistics.total);
+
+	return true;
+}
+
+bool Benchmark::SaveJSON(const std::string& fileName, const std::vector<Statistics>& statistics)
+{
+	std::ofstream file(fileName);
+	if (!file.is_open())
+		return false;
+
+	auto writePhase = [&file](const Statistics& stats, const char* name, const PhaseStatistics& phase) {
+		file << "\t\t\t\t\"" << name << "\": { "
+			<< "\"min_ms\": " << phase.minMS << ", "
+			<< "\"median_ms\": " << phase.medianMS << ", "
+			<< "\"p90_ms\": " << phase.p90MS << ", "
+			<< "\"p99_ms\": " << phase.p99MS << ", "
+			<< "\"max_ms\": " << phase.maxMS << ", "
+			<< "\"mean_ms\": " << phase.meanMS << ", "
+			<< "\"std_dev_ms\": " << phase.stdDevMS;
+
+		// Counts are means per iteration, the per vertex values divide them by the number of points.
+		auto writeCounts = [&](const char* group, double divisor) {
+			bool first = true;
+
+			file << ", \"" << group << "\": { ";
+			for (index_t c = 0; c < PerfCounters::NumCounters; ++c)
+			{
+				if (!stats.counterAvailable[c])
+					continue;
+
+				file << (first ? "" : ", ") << "\"" << PerfCounters::GetCounterName(static_cast<PerfCounters::Counter>(c)) << "\": " << phase.counts[c] / divisor;
+				first = false;
+			}
+			file << " }";
+		};
+
+		if (stats.countersMeasured)
+		{
+			writeCounts("counters", 1.0);
+			writeCounts("counters_per_vertex", static_cast<double>(std::max<int_t>(stats.numPoints, 1)));
+		}
+
+		if (stats.allocationsMeasured)
+		{
+			file << ", \"allocations\": " << phase.numAllocations
+				<< ", \"allocated_bytes\": " << phase.allocatedBytes
+				<< ", \"peak_live_bytes\": " << phase.peakLiveBytes;
+		}
+
+		file << " }";
+	};
+
+	auto writeValue = [&file](const char* name, const ValueStatistics& value) {
+		file << "\t\t\t\t\"" << name << "\": { "
+			<< "\"min\": " << value.min << ", "
+			<< "\"median\": " << value.median << ", "
+			<< "\"max\": " << value.max << ", "
+			<< "\"mean\": " << value.mean << ", "
+			<< "\"std_dev\": " << value.stdDev << " }";
+	};
+
+	file.precision(9);
+	file << "{\n\t\"results\": [\n";
+
+	for (index_t i = 0; i < statistics.size(); ++i)
+	{
+		const auto& stats = statistics[i];
+
+		file << "\t\t{\n"
+			<< "\t\t\t\"file\": \"" << EscapeJSON(stats.fileName) << "\",\n"
+			<< "\t\t\t\"engine\": \"" << GetTriangulatorName(stats.type) << "\",\n"
+			<< "\t\t\t\"segment_order\": \"" << GetSegmentOrderName(stats.segmentOrder) << "\",\n"
+			<< "\t\t\t\"seed\": " << stats.seed << ",\n"
+			<< "\t\t\t\"iterations\": " << stats.numIterations << ",\n"
+			<< "\t\t\t\"outlines\": " << stats.numOutlines << ",\n"
+			<< "\t\t\t\"points\": " << stats.numPoints << ",\n"
+			<< "\t\t\t\"triangles\": " << stats.numTriangles << ",\n"
+			<< "\t\t\t\"output_bytes\": " << stats.outputBytes << ",\n"
+			<< "\t\t\t\"phases\": {\n";
+
+		for (index_t p = 0; p < NumPhases; ++p)
+		{
+			if (stats.phases[p].measured)
+			{
+				writePhase(stats, Triangulator::GetPhaseName(static_cast<Triangulator::Phase>(p)), stats.phases[p]);
+				file << ",\n";
+			}
+		}
+
+		writePhase(stats, "total", stats.iteration);
+		file << "\n\t\t\t}";
+
+		if (stats.tree.measured)
+		{
+			file << ",\n\t\t\t\"tree\": {\n";
+			writeValue("max_depth", stats.tree.maxDepth);
+			file << ",\n";
+			writeValue("average_depth", stats.tree.averageDepth);
+			file << ",\n";
+			writeValue("nodes", stats.tree.numNodes);
+			file << ",\n";
+			writeValue("bytes", stats.tree.numBytes);
+			file << "\n\t\t\t}";
+		}
+
+		if (stats.framesMeasured)
+		{
+			file << ",\n\t\t\t\"frames\": {\n";
+			writeValue("count", stats.numFrames);
+			file << ",\n\t\t\t\t\"duration\": { "
+				<< "\"median_ms\": " << stats.frames.medianMS << ", "
+				<< "\"p99_ms\": " << stats.frames.p99MS << ", "
+				<< "\"max_ms\": " << stats.frames.maxMS << " }"
+				<< "\n\t\t\t}";
+		}
+
+		if (stats.engineMeasured)
+		{
+			// Mean per iteration, the histogram is summed over all iterations.
+			const auto& engine = stats.engine;
+			double divisor = static_cast<double>(std::max<int_t>(stats.numIterations, 1));
+			file << ",\n\t\t\t\"operations\": {\n"
+				<< "\t\t\t\t\"point_locations\": " << engine.numPointLocations / divisor << ",\n"
+				<< "\t\t\t\t\"nodes_visited\": " << engine.numNodesVisited / divisor << ",\n"
+				<< "\t\t\t\t\"max_location_depth\": " << engine.maxLocationDepth << ",\n"
+				<< "\t\t\t\t\"trapezoid_splits\": " << engine.numTrapezoidSplits / divisor << ",\n"
+				<< "\t\t\t\t\"merges\": " << engine.numMerges / divisor << ",\n"
+				<< "\t\t\t\t\"predicates\": " << engine.numPredicates / divisor << ",\n"
+				<< "\t\t\t\t\"monotone_chains\": " << engine.numMonotoneChains / divisor << ",\n"
+				<< "\t\t\t\t\"chain_length_histogram\": [";
+
+			index_t numBuckets = SeidelTriangulator::Statistics::NumChainLengthBuckets;
+			while (numBuckets > 1 && engine.chainLengthHistogram[numBuckets - 1] == 0)
+				--numBuckets;
+			for (index_t b = 0; b < numBuckets; ++b)
+				file << ((b > 0) ? ", " : "") << engine.chainLengthHistogram[b];
+
+			file << "]\n\t\t\t}";
+		}
+
+		file << "\n\t\t}" << ((i + 1 < statistics.size()) ? "," : "") << "\n";
+	}
+
+	file << "\t]\n}\n";
+
+	return file.good();
+}
+
+bool Benchmark::SaveCSV(const std::string& fileName, const std::vector<Statistics>& statistics)
+{
+	std::ofstream file(fileName);
+	if (!file.is_open())
+		return false;
+
+	auto writeRow = [&file](const Statistics& stats, const char* name, const PhaseStatistics& phase) {
+		file << QuoteCSV(stats.fileName) << "," << GetTriangulatorName(stats.type) << ","
+			<< GetSegmentOrderName(stats.segmentOrder) << "," << stats.seed << "," << stats.numIterations << ","
+			<< stats.numPoints << "," << stats.numTriangles << "," << name << ","
+			<< phase.minMS << "," << phase.medianMS << "," << phase.p90MS << "," << phase.p99MS << ","
+			<< phase.maxMS << "," << phase.meanMS << "," << phase.stdDevMS;
+
+		// Unavailable counters are left empty.
+		for (index_t c = 0; c < PerfCounters::NumCounters; ++c)
+		{
+			file << ",";
+			if (stats.counterAvailable[c])
+				file << phase.counts[c];
+		}
+
+		if (stats.allocationsMeasured)
+			file << "," << phase.numAllocations << "," << phase.allocatedBytes << "," << phase.peakLiveBytes;
+		else
+			file << ",,,";
+
+		file << "\n";
+	};
+
+	file.precision(9);
+	file << "file,engine,segment_order,seed,iterations,points,triangles,phase,min_ms,median_ms,p90_ms,p99_ms,max_ms,mean_ms,std_dev_ms";
+	for (index_t c = 0; c < PerfCounters::NumCounters; ++c)
+		file << "," << PerfCounters::GetCounterName(static_cast<PerfCounters::Counter>(c));
+	file << ",allocations,allocated_bytes,peak_live_bytes\n";
+
+	for (const auto& stats : statistics)
+	{
+		for (index_t p = 0; p < NumPhases; ++p)
+		{
+			if (stats.phases[p].measured)
+				writeRow(stats, Triangulator::GetPhaseName(static_cast<Triangulator::Phase>(p)), stats.phases[p]);
+		}
+
+		writeRow(stats, "total", stats.iteration);
+	}
+
+	return file.good();
+}
+
+bool Benchmark::SaveJSON(const std::string& fileName, const std::vector<ThroughputStatistics>& statistics)
+{
+	std::ofstream file(fileName);
+	if (!file.is_open())
+		return false;
+
+	file.precision(9);
+	file << "{\n\t\"throughput\": [\n";
+
+	for (index_t i = 0; i < statistics.size(); ++i)
+	{
+		const auto& stats = statistics[i];
+
+		file << "\t\t{ "
+			<< "\"engine\": \"" << GetTriangulatorName(stats.type) << "\", "
+			<< "\"threads\": " << stats.numThreads << ", "
+			<< "\"rounds\": " << stats.numRounds << ", "
+			<< "\"polygons\": " << stats.numPolygons << ", "
+			<< "\"vertices\": " << stats.numVertices << ", "
+			<< "\"time_ms\": " << stats.timeMS << ", "
+			<< "\"polygons_per_second\": " << stats.polygonsPerSecond << ", "
+			<< "\"vertices_per_second\": " << stats.verticesPerSecond << ", "
+			<< "\"efficiency\": " << stats.efficiency << " }"
+			<< ((i + 1 < statistics.size()) ? "," : "") << "\n";
+	}
+
+	file << "\t]\n}\n";
+
+	return file.good();
+}
+
+bool Benchmark::SaveCSV(const std::string& fileName, const std::vector<ThroughputStatistics>& statistics)
+{
+	std::ofstream file(fileName);
+	if (!file.is_open())
+		return false;
+
+	file.precision(9);
+	file << "engine,threads,rounds,polygons,vertices,time_ms,polygons_per_second,vertices_per_second,efficiency\n";
+
+	for (const auto& stats : statistics)
+	{
+		file << GetTriangulatorName(stats.type) << "," << stats.numThreads << "," << stats.numRounds << ","
+			<< stats.numPolygons << "," << stats.numVertices << "," << stats.timeMS << ","
+			<< stats.polygonsPerSecond << "," << stats.verticesPerSecond << "," << stats.efficiency << "\n";
+	}
+
+	return file.good();
+}
+
+bool Benchmark::SaveJSON(const std::string& fileName, const std::vector<EndToEndStatistics>& statistics)
+{
+	std::ofstream file(fileName);
+	if (!file.is_open())
+		return false;
+
+	auto writeStage = [&file](const char* name, const PhaseStatistics& stage) {
+		file << "\t\t\t\t\"" << name << "\": { "
+			<< "\"min_ms\": " << stage.minMS << ", "
+			<< "\"median_ms\": " << stage.medianMS << ", "
+			<< "\"p90_ms\": " << stage.p90MS << ", "
+			<< "\"max_ms\": " << stage.maxMS << ", "
+			<< "\"mean_ms\": " << stage.meanMS << " }";
+	};
+
+	file.precision(9);
+	file << "{\n\t\"end_to_end\": [\n";
+
+	for (index_t i = 0; i < statistics.size(); ++i)
+	{
+		const auto& stats = statistics[i];
+
+		file << "\t\t{\n"
+			<< "\t\t\t\"file\": \"" << EscapeJSON(stats.fileName) << "\",\n"
+			<< "\t\t\t\"engine\": \"" << GetTriangulatorName(stats.type) << "\",\n"
+			<< "\t\t\t\"iterations\": " << stats.numIterations << ",\n"
+			<< "\t\t\t\"points\": " << stats.numPoints << ",\n"
+			<< "\t\t\t\"triangles\": " << stats.numTriangles << ",\n"
+			<< "\t\t\t\"cache_dropped\": " << (stats.cacheDropped ? "true" : "false") << ",\n"
+			<< "\t\t\t\"binary_output\": " << (stats.binaryOutput ? "true" : "false") << ",\n"
+			<< "\t\t\t\"stages\": {\n";
+
+		for (index_t st = 0; st < NumStages; ++st)
+		{
+			writeStage(GetStageName(static_cast<Stage>(st)), stats.stages[st]);
+			file << ",\n";
+		}
+
+		writeStage("total", stats.total);
+		file << "\n\t\t\t}\n\t\t}" << ((i + 1 < statistics.size()) ? "," : "") << "\n";
+	}
+
+	file << "\t]\n}\n";
+
+	return file.good();
+}
+
+bool Benchmark::SaveCSV(const std::string& fileName, const std::vector<EndToEndStatistics>& statistics)
+{
+	std::ofstream file(fileName);
+	if (!file.is_open())
+		return false;
+
+	auto writeRow = [&file](const EndToEndStatistics& stats, const char* name, const PhaseStatistics& stage) {
+		file << QuoteCSV(stats.fileName) << "," << GetTriangulatorName(stats.type) << "," << stats.numIterations << ","
+			<< stats.numPoints << "," << stats.numTriangles << "," << (stats.cacheDropped ? 1 : 0) << "," << (stats.binaryOutput ? 1 : 0) << "," << name << ","
+			<< stage.minMS << "," << stage.medianMS << "," << stage.p90MS << "," << stage.maxMS << "," << stage.meanMS << "\n";
+	};
+
+	file.precision(9);
+	file << "file,engine,iterations,points,triangles,cache_dropped,binary_output,stage,min_ms,median_ms,p90_ms,max_ms,mean_ms\n";
+
+	for (const auto& stats : statistics)
+	{
+		for (index_t st = 0; st < NumStages; ++st)
+			writeRow(stats, GetStageName(static_cast<Stage>(st)), stats.stages[st]);
+
+		writeRow(stats, "total", stats.total);
+	}
+
+	return file.good();
+}
+
+// Percentiles use the nearest rank method.
+void Benchmark::CalculatePhaseStatistics(std::vector<double>& samples, PhaseStatistics& statistics)
+{
+	statistics = { };
+
+	if (samples.empty())
+		return;
+
+	std::sort(samples.begin(), samples.end());
+
+	auto percentile = [&samples](double p) {
+		index_t rank = static_cast<index_t>(std::ceil(p / 100.0 * samples.size()));
+		return samples[std::clamp<index_t>(rank - 1, 0, samples.size() - 1)];
+	};
+
+	double sum = 0.0;
+	for (double s : samples)
+		sum += s;
+
+	statistics.measured = true;
+	statistics.minMS = samples.front();
+	statistics.medianMS = percentile(50.0);
+	statistics.p90MS = percentile(90.0);
+	statistics.p99MS = percentile(99.0);
+	statistics.maxMS = samples.back();
+	statistics.meanMS = sum / samples.size();
+	statistics.stdDevMS = StandardDeviation(samples, statistics.meanMS);
+}
+
+void Benchmark::CalculateValueStatistics(std::vector<double>& samples, ValueStatistics& statistics)
+{
+	statistics = { };
+
+	if (samples.empty())
+		return;
+
+	std::sort(samples.begin(), samples.end());
+
+	double sum = 0.0;
+	for (double s : samples)
+		sum += s;
+
+	statistics.min = samples.front();
+	statistics.median = samples[(samples.size() - 1) / 2];
+	statistics.max = samples.back();
+	statistics.mean = sum / samples.size();
+	statistics.stdDev = StandardDeviation(samples, statistics.mean);
+}
+
+// Sample standard deviation, zero for a single sample.
+double Benchmark::StandardDeviation(const std::vector<double>& samples, double mean)
+{
+	if (samples.size() < 2)
+		return 0.0;
+
+	double sum = 0.0;
+	for (double s : samples)
+		sum += (s - mean) * (s - mean);
+
+	return std::sqrt(sum / (samples.size() - 1));
+}
+
+// Evict the file from the page cache, so that the next read comes from the disk. Needs no privileges,
+// as it only drops clean pages of a file the process can open.
+bool Benchmark::DropFileCache(const std::string& fileName)
+{
+#ifdef __linux__
+	int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd == -1)
+		return false;
+
+	bool dropped = (posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0);
+	close(fd);
+
+	return dropped;
+#else
+	return false;
+#endif
+}
+
+const char* Benchmark::GetStageName(Stage stage)
+{
+	switch (stage)
+	{
+	case Stage::Load:
+		return "load";
+	case Stage::Construction:
+		return "construction";
+	case Stage::Triangulation:
+		return "triangulation";
+	case Stage::SaveIndices:
+		return "save_indices";
+	case Stage::SavePoints:
+		return "save_points";
+	}
+
+	return "";
+}
+
+const char* Benchmark::GetSegmentOrderName(SegmentOrder order)
+{
+	switch (order)
+	{
+	case SegmentOrder::Fixed:
+		return "fixed";
+	case SegmentOrder::Reshuffle:
+		return "reshuffle";
+	}
+
+	return "";
+}
+
+bool Benchmark::ParseSegmentOrder(const std::string& name, SegmentOrder& order)
+{
+	for (auto o : { SegmentOrder::Fixed, SegmentOrder::Reshuffle })
+	{
+		if (name == GetSegmentOrderName(o))
+		{
+			order = o;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void Benchmark::PhaseTimer::Reset()
+{
+	std::fill(std::begin(timesMS), std::end(timesMS), 0.0);
+	std::fill(std::begin(measured), std::end(measured), false);
+	for (auto& phaseCounts : counts)
+		phaseCounts.fill(0);
+	std::fill(std::begin(numAllocations), std::end(numAllocations), 0);
+	std::fill(std::begin(allocatedBytes), std::end(allocatedBytes), 0);
+	std::fill(std::begin(peakLiveBytes), std::end(peakLiveBytes), 0);
+	maxLiveBytes = 0;
+}
+
+void Benchmark::PhaseTimer::OnPhaseBegin(Triangulator::Phase phase)
+{
+	index_t p = static_cast<index_t>(phase);
+
+	if (trace != nullptr)
+		trace->OnPhaseBegin(phase);
+
+	// Counters are read before the clock starts and after it stops, keeping the read out of the time.
+	if (trackAllocations)
+	{
+		AllocationTracker::GetCounts(_startAllocations[p]);
+		maxLiveBytes = std::max(maxLiveBytes, _startAllocations[p].peakLiveBytes);
+		AllocationTracker::ResetPeak();
+	}
+
+	if (counters != nullptr)
+		counters->Read(_startCounts[p]);
+
+	_startTimes[p] = std::chrono::high_resolution_clock::now();
+}
+
+void Benchmark::PhaseTimer::OnPhaseEnd(Triangulator::Phase phase)
+{
+	auto endTime = std::chrono::high_resolution_clock::now();
+	index_t p = static_cast<index_t>(phase);
+	timesMS[p] += std::chrono::duration<double, std::chrono::milliseconds::period>(endTime - _startTimes[p]).count();
+	measured[p] = true;
+
+	if (counters != nullptr)
+	{
+		PerfCounters::Values endCounts;
+		counters->Read(endCounts);
+		for (index_t c = 0; c < PerfCounters::NumCounters; ++c)
+			counts[p][c] += endCounts[c] - _startCounts[p][c];
+	}
+
+	if (trackAllocations)
+	{
+		AllocationTracker::Counts endAllocations;
+		AllocationTracker::GetCounts(endAllocations);
+		const auto& startAllocations = _startAllocations[p];
+
+		numAllocations[p] += endAllocations.numAllocations - startAllocations.numAllocations;
+		allocatedBytes[p] += endAllocations.numBytes - startAllocations.numBytes;
+		peakLiveBytes[p] = std::max(peakLiveBytes[p], endAllocations.peakLiveBytes - startAllocations.liveBytes);
+		maxLiveBytes = std::max(maxLiveBytes, endAllocations.peakLiveBytes);
+		AllocationTracker::ResetPeak();
+	}
+
+	if (trace != nullptr)
+		trace->OnPhaseEnd(phase);
 }
@@ -3,24 +3,213 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include "Triangulator.h"
 #include "SeidelTriangulator.h"
+#include "PerfCounters.h"
+#include "AllocationTracker.h"
+#include "TraceRecorder.h"
 
 class Benchmark
 {
 public:
+	static constexpr index_t NumPhases = static_cast<index_t>(Triangulator::Phase::Count);
+
+	// Stages of the end-to-end run, from the polygon file to the written triangles.
+	enum class Stage
+	{
+		Load,
+		Construction,
+		Triangulation,
+		SaveIndices,
+		SavePoints,
+		Count
+	};
+
+	static constexpr index_t NumStages = static_cast<index_t>(Stage::Count);
+
+	// How the random segment order of the Seidel engine is chosen for each iteration.
+	enum class SegmentOrder
+	{
+		Fixed,		// Every iteration uses the order generated from the seed, only the timing varies.
+		Reshuffle,	// Iteration i uses seed + i, so the spread includes the variance of the algorithm.
+	};
+
+	// Distribution of the per-iteration times of one phase.
+	struct PhaseStatistics
+	{
+		bool measured = false;	// The engine reported this phase.
+		double minMS = 0.0;
+		double medianMS = 0.0;
+		double p90MS = 0.0;
+		double p99MS = 0.0;
+		double maxMS = 0.0;
+		double meanMS = 0.0;
+		double stdDevMS = 0.0;
+		double counts[PerfCounters::NumCounters] = { };	// Hardware counts, mean per iteration.
+		double numAllocations = 0.0;	// Mean per iteration.
+		double allocatedBytes = 0.0;	// Mean per iteration.
+		int_t peakLiveBytes = 0;		// Highest rise of the live heap bytes over their level at the start.
+	};
+
+	// Distribution of a per-iteration value that is not a time.
+	struct ValueStatistics
+	{
+		double min = 0.0;
+		double median = 0.0;
+		double max = 0.0;
+		double mean = 0.0;
+		double stdDev = 0.0;
+	};
+
+	// Shape of the history DAG built by the Seidel engine, over all iterations.
+	struct TreeStatistics
+	{
+		bool measured = false;
+		ValueStatistics maxDepth;
+		ValueStatistics averageDepth;
+		ValueStatistics numNodes;
+		ValueStatistics numBytes;
+	};
+
 	struct Statistics
 	{
+		std::string fileName;
+		TriangulatorType type = TriangulatorType::Seidel;
+		int_t numIterations = 0;
 		int_t numOutlines = 0;
 		int_t numPoints = 0;
+		int_t numTriangles = 0;
 		double totalTimeMS = 0.0f;
 		double averageTimeMS = 0.0f;
+		PhaseStatistics phases[NumPhases];
+		PhaseStatistics iteration;	// Construction and triangulation together.
+		PhaseStatistics algorithm;	// The iteration without the validation of the polygon.
+		SegmentOrder segmentOrder = SegmentOrder::Reshuffle;
+		std::uint32_t seed = 0;
+		TreeStatistics tree;
+		bool countersMeasured = false;
+		bool counterAvailable[PerfCounters::NumCounters] = { };
+		bool allocationsMeasured = false;
+		int_t outputBytes = 0;	// Size of the triangle index list.
+		bool framesMeasured = false;	// The Seidel engine ran in resumable steps, see SetFrameBudget().
+		ValueStatistics numFrames;		// Step() calls per iteration.
+		PhaseStatistics frames;			// Duration of the single Step() calls.
+		bool engineMeasured = false;	// The Seidel engine was built with SEIDEL_STATISTICS.
+		SeidelTriangulator::Statistics engine;	// Summed over all iterations, except maxLocationDepth which is the highest.
 	};
 
-	bool LoadPolygon(const char* polygonFileName, std::string& errDesc);
+	struct EndToEndStatistics
+	{
+		std::string fileName;
+		TriangulatorType type = TriangulatorType::Seidel;
+		int_t numIterations = 0;
+		int_t numPoints = 0;
+		int_t numTriangles = 0;
+		bool cacheDropped = false;	// The input file was evicted from the page cache before every iteration.
+		bool binaryOutput = false;	// The triangles were written in the binary formats.
+		PhaseStatistics stages[NumStages];
+		PhaseStatistics total;
+	};
+
+	// Result of one throughput run.
+	struct ThroughputStatistics
+	{
+		TriangulatorType type = TriangulatorType::Seidel;
+		int_t numThreads = 0;
+		int_t numRounds = 0;		// Passes over the corpus made by each thread.
+		int_t numPolygons = 0;		// Triangulated by all threads together.
+		int_t numVertices = 0;
+		double timeMS = 0.0;
+		double polygonsPerSecond = 0.0;
+		double verticesPerSecond = 0.0;
+		double efficiency = 0.0;	// Throughput relative to numThreads times the single thread throughput.
+	};
+
+	bool LoadPolygon(const char* polygonFileName, TriangulatorType type, std::string& errDesc);
+	bool SetPolygon(OutlineList outlines, const std::string& name, TriangulatorType type, std::string& errDesc);
+	void SetSegmentOrder(SegmentOrder order, std::uint32_t seed);
+	// Count hardware events per phase. Each phase boundary then costs a system call, which shows in the times.
+	void SetCollectCounters(bool collect) { _collectCounters = collect; }
+	// Count heap allocations per phase. Has an effect only if AllocationTracker is enabled.
+	void SetTrackAllocations(bool track) { _trackAllocations = track; }
+	// Record the iterations and the engine phases into the recorder as well.
+	void SetTraceRecorder(TraceRecorder* recorder) { _traceRecorder = recorder; }
+	// Run the Seidel engine with BeginSteps() and Step() calls of at most maxTimeMS each, like a frame loop that
+	// spreads the work over frames. A negative value triangulates in one call.
+	void SetFrameBudget(double maxTimeMS) { _frameBudgetMS = maxTimeMS; }
+	// Each iteration constructs a new triangulator and triangulates the polygon.
 	void Run(int numIterations, Statistics& statistics);
 
+	// Every thread triangulates its own copy of the corpus numRounds times. The clock runs from the moment all
+	// threads have their copies until the last one finishes. The efficiency is left for the caller to fill in.
+	// If trace recorders are given, there has to be one for each thread.
+	static void RunThroughput(const std::vector<OutlineList>& corpus, TriangulatorType type, int_t numThreads, int_t numRounds, ThroughputStatistics& statistics,
+		std::vector<TraceRecorder>* traceRecorders = nullptr);
+
+	// Load, triangulate and save the polygon in each iteration, timing every stage. The triangles are written to
+	// outputPrefix with the .tind and .tpts extensions, or .btind and .btpts with binaryOutput. With dropCache
+	// the input file is evicted from the page cache before each load where the system allows it, otherwise
+	// the loads are warm.
+	static bool RunEndToEnd(const std::string& polyFile, const std::string& outputPrefix, TriangulatorType type, int numIterations, bool dropCache,
+		bool binaryOutput, EndToEndStatistics& statistics, std::string& errDesc);
+
+	static const char* GetStageName(Stage stage);
+	static const char* GetSegmentOrderName(SegmentOrder order);
+	static bool ParseSegmentOrder(const std::string& name, SegmentOrder& order);
+	static bool SaveJSON(const std::string& fileName, const std::vector<Statistics>& statistics);
+	static bool SaveCSV(const std::string& fileName, const std::vector<Statistics>& statistics);
+	static bool SaveJSON(const std::string& fileName, const std::vector<ThroughputStatistics>& statistics);
+	static bool SaveCSV(const std::string& fileName, const std::vector<ThroughputStatistics>& statistics);
+	static bool SaveJSON(const std::string& fileName, const std::vector<EndToEndStatistics>& statistics);
+	static bool SaveCSV(const std::string& fileName, const std::vector<EndToEndStatistics>& statistics);
+
 private:
-	std::unique_ptr<SeidelTriangulator> _triangulator;
+	// Accumulates the time spent in each phase of the current iteration.
+	class PhaseTimer : public Triangulator::PhaseListener
+	{
+	public:
+		void Reset();
+		void OnPhaseBegin(Triangulator::Phase phase) override;
+		void OnPhaseEnd(Triangulator::Phase phase) override;
+		bool WantsDetails() const override { return trace != nullptr && trace->WantsDetails(); }
+		void OnDetailBegin(const char* name, index_t index) override { trace->OnDetailBegin(name, index); }
+		void OnDetailEnd(const char* name, index_t index) override { trace->OnDetailEnd(name, index); }
+
+		double timesMS[NumPhases];
+		bool measured[NumPhases];
+		PerfCounters* counters = nullptr;	// Read at the phase boundaries when set.
+		PerfCounters::Values counts[NumPhases];
+		bool trackAllocations = false;
+		int_t numAllocations[NumPhases];
+		int_t allocatedBytes[NumPhases];
+		int_t peakLiveBytes[NumPhases];
+		int_t maxLiveBytes = 0;	// The tracker's peak is reset at each boundary, this keeps the highest one.
+		TraceRecorder* trace = nullptr;	// Receives the phases and details as well.
+
+	private:
+		std::chrono::high_resolution_clock::time_point _startTimes[NumPhases];
+		PerfCounters::Values _startCounts[NumPhases];
+		AllocationTracker::Counts _startAllocations[NumPhases];
+	};
+
+	static void CalculatePhaseStatistics(std::vector<double>& samples, PhaseStatistics& statistics);
+	static void CalculateValueStatistics(std::vector<double>& samples, ValueStatistics& statistics);
+	static double StandardDeviation(const std::vector<double>& samples, double mean);
+	static bool DropFileCache(const std::string& fileName);
+
+	std::string _fileName;
+	TriangulatorType _type = TriangulatorType::Seidel;
+	OutlineList _outlines;
+	int_t _numPoints = 0;
+	SegmentOrder _segmentOrder = SegmentOrder::Reshuffle;
+	std::uint32_t _seed = 1;
+	bool _collectCounters = false;
+	bool _trackAllocations = false;
+	TraceRecorder* _traceRecorder = nullptr;
+	double _frameBudgetMS = -1.0;
 };
 
 #endif // _BENCHMARK_H_
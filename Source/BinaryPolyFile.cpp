@@ -0,0 +1,415 @@
+#include "BinaryPolyFile.h"
+#include <fstream>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+// Layout of the file header.
+struct BinaryPolyHeader
+{
+	char magic[4];
+	std::uint16_t version;
+	std::uint16_t scalarType;
+	std::int64_t numOutlines;
+	std::int64_t numPoints;
+};
+
+static_assert(sizeof(BinaryPolyHeader) == 24, "The header must have no padding.");
+static_assert(sizeof(math3d::vec2f) == 2 * sizeof(float) && sizeof(math3d::vec2d) == 2 * sizeof(double),
+	"The coordinates are used from the mapping as vectors.");
+
+static_assert(sizeof(BinaryPolyFile::Box) == 4 * sizeof(float), "The index boxes are used from the mapping.");
+
+static index_t GetScalarSize(BinaryPolyFile::ScalarType scalarType)
+{
+	return (scalarType == BinaryPolyFile::ScalarType::Double) ? sizeof(double) : sizeof(float);
+}
+
+static BinaryPolyFile::Box GetEmptyBox()
+{
+	const float inf = std::numeric_limits<float>::infinity();
+	return { { inf, inf }, { -inf, -inf } };
+}
+
+static void AddToBox(BinaryPolyFile::Box& box, const BinaryPolyFile::Box& other)
+{
+	box.min = { std::min(box.min.x, other.min.x), std::min(box.min.y, other.min.y) };
+	box.max = { std::max(box.max.x, other.max.x), std::max(box.max.y, other.max.y) };
+}
+
+static bool BoxesIntersect(const BinaryPolyFile::Box& a, const BinaryPolyFile::Box& b)
+{
+	return a.min.x <= b.max.x && b.min.x <= a.max.x && a.min.y <= b.max.y && b.min.y <= a.max.y;
+}
+
+// Float box that contains the double point, rounded outward.
+static BinaryPolyFile::Box GetPointBox(const math3d::vec2d& pt)
+{
+	const float inf = std::numeric_limits<float>::infinity();
+	math3d::vec2f rounded(pt);
+	BinaryPolyFile::Box box = { rounded, rounded };
+
+	if (box.min.x > pt.x)
+		box.min.x = std::nextafter(box.min.x, -inf);
+	if (box.min.y > pt.y)
+		box.min.y = std::nextafter(box.min.y, -inf);
+	if (box.max.x < pt.x)
+		box.max.x = std::nextafter(box.max.x, inf);
+	if (box.max.y < pt.y)
+		box.max.y = std::nextafter(box.max.y, inf);
+
+	return box;
+}
+
+template <class _PT>
+static void GetOutlineBoxes(const _PT* coords, const std::int64_t* outlineOffsets, index_t numOutlines, std::vector<BinaryPolyFile::Box>& outBoxes)
+{
+	outBoxes.assign(numOutlines, GetEmptyBox());
+	for (index_t i = 0; i < numOutlines; ++i)
+	{
+		for (index_t p = outlineOffsets[i]; p < outlineOffsets[i + 1]; ++p)
+			AddToBox(outBoxes[i], GetPointBox(math3d::vec2d(coords[p].x, coords[p].y)));
+	}
+}
+
+// Position of the cell along the Hilbert curve that fills a 65536 x 65536 grid.
+static std::uint64_t HilbertIndex(std::uint32_t x, std::uint32_t y)
+{
+	const std::uint32_t size = 1 << 16;
+	std::uint64_t d = 0;
+
+	for (std::uint32_t s = size / 2; s > 0; s /= 2)
+	{
+		std::uint32_t rx = (x & s) ? 1 : 0;
+		std::uint32_t ry = (y & s) ? 1 : 0;
+		d += std::uint64_t(s) * s * ((3 * rx) ^ ry);
+
+		if (ry == 0)
+		{
+			if (rx == 1)
+			{
+				x = size - 1 - x;
+				y = size - 1 - y;
+			}
+			std::swap(x, y);
+		}
+	}
+
+	return d;
+}
+
+bool BinaryPolyFile::Open(const std::string& fileName, MappedFile::Access access)
+{
+	Close();
+
+	if (!_file.Open(fileName, access))
+		return false;
+
+	// A big-endian reader sees a different version and rejects the file.
+	BinaryPolyHeader header;
+	if (_file.GetSize() < sizeof(header))
+	{
+		Close();
+		return false;
+	}
+
+	std::memcpy(&header, _file.GetData(), sizeof(header));
+	if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || (header.version != 1 && header.version != Version) ||
+		header.scalarType > static_cast<std::uint16_t>(ScalarType::Double) ||
+		header.numOutlines < 0 || header.numPoints < 0)
+	{
+		Close();
+		return false;
+	}
+
+	_scalarType = static_cast<ScalarType>(header.scalarType);
+
+	// Counts that can't fit would overflow the sizes below.
+	if (header.numOutlines >= _file.GetSize() / sizeof(std::int64_t) || header.numPoints > _file.GetSize() / (2 * GetScalarSize(_scalarType)))
+	{
+		Close();
+		return false;
+	}
+
+	index_t offsetsSize = (header.numOutlines + 1) * sizeof(std::int64_t);
+	index_t indexSize = (header.version >= 2) ? GetNumIndexNodes(header.numOutlines) * sizeof(Box) + header.numOutlines * sizeof(std::int64_t) : 0;
+	index_t coordsSize = header.numPoints * 2 * GetScalarSize(_scalarType);
+	if (_file.GetSize() != sizeof(header) + offsetsSize + indexSize + coordsSize)
+	{
+		Close();
+		return false;
+	}
+
+	_numOutlines = header.numOutlines;
+	_numPoints = header.numPoints;
+	_outlineOffsets = reinterpret_cast<const std::int64_t*>(_file.GetData() + sizeof(header));
+	_coords = _file.GetData() + sizeof(header) + offsetsSize + indexSize;
+
+	if (header.version >= 2)
+	{
+		_indexBoxes = reinterpret_cast<const Box*>(_file.GetData() + sizeof(header) + offsetsSize);
+		_leafOrder = reinterpret_cast<const std::int64_t*>(_indexBoxes + GetNumIndexNodes(_numOutlines));
+	}
+
+	// The offsets are checked once here, so that the users can index with them freely.
+	bool validOffsets = (_outlineOffsets[0] == 0 && _outlineOffsets[_numOutlines] == _numPoints);
+	for (index_t i = 0; validOffsets && i < _numOutlines; ++i)
+		validOffsets = (_outlineOffsets[i] <= _outlineOffsets[i + 1]);
+
+	for (index_t i = 0; validOffsets && HasIndex() && i < _numOutlines; ++i)
+		validOffsets = (_leafOrder[i] >= 0 && _leafOrder[i] < _numOutlines);
+
+	if (!validOffsets)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void BinaryPolyFile::Close()
+{
+	_file.Close();
+	_scalarType = ScalarType::Float;
+	_numOutlines = 0;
+	_numPoints = 0;
+	_outlineOffsets = nullptr;
+	_coords = nullptr;
+	_indexBoxes = nullptr;
+	_leafOrder = nullptr;
+}
+
+const math3d::vec2f* BinaryPolyFile::GetFloatCoords() const
+{
+	return (_scalarType == ScalarType::Float) ? static_cast<const math3d::vec2f*>(_coords) : nullptr;
+}
+
+const math3d::vec2d* BinaryPolyFile::GetDoubleCoords() const
+{
+	return (_scalarType == ScalarType::Double) ? static_cast<const math3d::vec2d*>(_coords) : nullptr;
+}
+
+void BinaryPolyFile::GetOutlines(OutlineList& outOutlines) const
+{
+	outOutlines.reserve(outOutlines.size() + _numOutlines);
+
+	for (index_t i = 0; i < _numOutlines; ++i)
+		AppendOutline(i, outOutlines);
+}
+
+void BinaryPolyFile::GetOutlines(const IndexList& outlineIndices, OutlineList& outOutlines) const
+{
+	outOutlines.reserve(outOutlines.size() + outlineIndices.size());
+
+	for (auto i : outlineIndices)
+		AppendOutline(i, outOutlines);
+}
+
+void BinaryPolyFile::FindOutlines(const Box& rect, IndexList& outOutlineIndices) const
+{
+	outOutlineIndices.clear();
+
+	if (!HasIndex())
+	{
+		for (index_t i = 0; i < _numOutlines; ++i)
+		{
+			if (BoxesIntersect(GetOutlineBox(i), rect))
+				outOutlineIndices.push_back(i);
+		}
+		return;
+	}
+
+	if (_numOutlines == 0)
+		return;
+
+	// Start of each level, the leaves first and the root last.
+	std::vector<index_t> levelStarts(1, 0);
+	for (index_t count = _numOutlines; count > 1; count = (count + IndexNodeSize - 1) / IndexNodeSize)
+		levelStarts.push_back(levelStarts.back() + count);
+	levelStarts.push_back(levelStarts.back() + 1);
+
+	// Nodes to visit, with their levels.
+	std::vector<std::pair<index_t, index_t>> stack;
+	stack.push_back({ levelStarts[levelStarts.size() - 2], levelStarts.size() - 2 });
+
+	while (!stack.empty())
+	{
+		auto [node, level] = stack.back();
+		stack.pop_back();
+
+		if (!BoxesIntersect(_indexBoxes[node], rect))
+			continue;
+
+		if (level == 0)
+		{
+			outOutlineIndices.push_back(_leafOrder[node]);
+			continue;
+		}
+
+		index_t firstChild = levelStarts[level - 1] + (node - levelStarts[level]) * IndexNodeSize;
+		index_t endChild = std::min(firstChild + IndexNodeSize, levelStarts[level]);
+		for (index_t child = firstChild; child < endChild; ++child)
+			stack.push_back({ child, level - 1 });
+	}
+
+	std::sort(outOutlineIndices.begin(), outOutlineIndices.end());
+}
+
+index_t BinaryPolyFile::GetNumIndexNodes(index_t numOutlines)
+{
+	index_t numNodes = 0;
+	for (index_t count = numOutlines; count > 0; count = (count > 1) ? (count + IndexNodeSize - 1) / IndexNodeSize : 0)
+		numNodes += count;
+
+	return numNodes;
+}
+
+void BinaryPolyFile::BuildIndex(const std::vector<Box>& outlineBoxes, std::vector<Box>& outNodes, std::vector<std::int64_t>& outLeafOrder)
+{
+	index_t numOutlines = outlineBoxes.size();
+	Box bounds = GetEmptyBox();
+	for (const auto& box : outlineBoxes)
+		AddToBox(bounds, box);
+
+	// Box centers on the 65536 x 65536 grid over the bounds. Empty outlines go to the end.
+	std::vector<std::uint64_t> hilbertIndices(numOutlines, std::numeric_limits<std::uint64_t>::max());
+	double width = std::max(static_cast<double>(bounds.max.x) - bounds.min.x, 1e-30);
+	double height = std::max(static_cast<double>(bounds.max.y) - bounds.min.y, 1e-30);
+	for (index_t i = 0; i < numOutlines; ++i)
+	{
+		const auto& box = outlineBoxes[i];
+		if (box.min.x > box.max.x)
+			continue;
+
+		double x = 0.5 * (static_cast<double>(box.min.x) + box.max.x) - bounds.min.x;
+		double y = 0.5 * (static_cast<double>(box.min.y) + box.max.y) - bounds.min.y;
+		hilbertIndices[i] = HilbertIndex(
+			static_cast<std::uint32_t>(std::clamp(x / width * 65535.0, 0.0, 65535.0)),
+			static_cast<std::uint32_t>(std::clamp(y / height * 65535.0, 0.0, 65535.0)));
+	}
+
+	outLeafOrder.resize(numOutlines);
+	for (index_t i = 0; i < numOutlines; ++i)
+		outLeafOrder[i] = i;
+	std::stable_sort(outLeafOrder.begin(), outLeafOrder.end(),
+		[&hilbertIndices](std::int64_t a, std::int64_t b) { return hilbertIndices[a] < hilbertIndices[b]; });
+
+	outNodes.clear();
+	outNodes.reserve(GetNumIndexNodes(numOutlines));
+	for (auto i : outLeafOrder)
+		outNodes.push_back(outlineBoxes[i]);
+
+	// Each level is built from the one before it, until a single box is left.
+	for (index_t levelStart = 0, count = numOutlines; count > 1; )
+	{
+		index_t levelEnd = levelStart + count;
+		for (index_t first = levelStart; first < levelEnd; first += IndexNodeSize)
+		{
+			Box box = GetEmptyBox();
+			for (index_t child = first; child < std::min(first + IndexNodeSize, levelEnd); ++child)
+				AddToBox(box, outNodes[child]);
+			outNodes.push_back(box);
+		}
+
+		levelStart = levelEnd;
+		count = outNodes.size() - levelEnd;
+	}
+}
+
+BinaryPolyFile::Box BinaryPolyFile::GetOutlineBox(index_t outlineIndex) const
+{
+	Box box = GetEmptyBox();
+	for (index_t p = _outlineOffsets[outlineIndex]; p < _outlineOffsets[outlineIndex + 1]; ++p)
+	{
+		if (_scalarType == ScalarType::Float)
+			AddToBox(box, { GetFloatCoords()[p], GetFloatCoords()[p] });
+		else
+			AddToBox(box, GetPointBox(GetDoubleCoords()[p]));
+	}
+
+	return box;
+}
+
+void BinaryPolyFile::AppendOutline(index_t outlineIndex, OutlineList& outOutlines) const
+{
+	index_t start = _outlineOffsets[outlineIndex];
+	index_t end = _outlineOffsets[outlineIndex + 1];
+
+	if (_scalarType == ScalarType::Float)
+	{
+		outOutlines.emplace_back(GetFloatCoords() + start, GetFloatCoords() + end);
+	}
+	else
+	{
+		Outline outline(end - start);
+		for (index_t p = start; p < end; ++p)
+			outline[p - start] = math3d::vec2f(GetDoubleCoords()[p]);
+		outOutlines.push_back(std::move(outline));
+	}
+}
+
+bool BinaryPolyFile::IsBinaryPolyFile(const std::string& fileName)
+{
+	std::ifstream file(fileName, std::ios::binary);
+	char magic[sizeof(Magic)];
+
+	return (file.read(magic, sizeof(magic)) && std::memcmp(magic, Magic, sizeof(Magic)) == 0);
+}
+
+bool BinaryPolyFile::Save(const std::string& fileName, const OutlineList& outlines)
+{
+	std::vector<std::int64_t> outlineOffsets(1, 0);
+	std::vector<math3d::vec2f> coords;
+	for (const auto& outl : outlines)
+	{
+		coords.insert(coords.end(), outl.begin(), outl.end());
+		outlineOffsets.push_back(coords.size());
+	}
+
+	std::vector<Box> outlineBoxes;
+	GetOutlineBoxes(coords.data(), outlineOffsets.data(), outlines.size(), outlineBoxes);
+
+	return Save(fileName, ScalarType::Float, outlines.size(), coords.size(), outlineOffsets.data(), coords.data(), outlineBoxes);
+}
+
+bool BinaryPolyFile::Save(const std::string& fileName, const std::vector<math3d::vec2d>& pointCoords, const IndexList& outlineOffsets)
+{
+	if (outlineOffsets.empty() || outlineOffsets.front() != 0 || outlineOffsets.back() != pointCoords.size())
+		return false;
+
+	std::vector<std::int64_t> offsets(outlineOffsets.begin(), outlineOffsets.end());
+
+	std::vector<Box> outlineBoxes;
+	GetOutlineBoxes(pointCoords.data(), offsets.data(), offsets.size() - 1, outlineBoxes);
+
+	return Save(fileName, ScalarType::Double, offsets.size() - 1, pointCoords.size(), offsets.data(), pointCoords.data(), outlineBoxes);
+}
+
+bool BinaryPolyFile::Save(const std::string& fileName, ScalarType scalarType, index_t numOutlines, index_t numPoints,
+	const std::int64_t* outlineOffsets, const void* coords, const std::vector<Box>& outlineBoxes)
+{
+	std::vector<Box> indexBoxes;
+	std::vector<std::int64_t> leafOrder;
+	BuildIndex(outlineBoxes, indexBoxes, leafOrder);
+
+	std::ofstream file(fileName, std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	BinaryPolyHeader header = { };
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.scalarType = static_cast<std::uint16_t>(scalarType);
+	header.numOutlines = numOutlines;
+	header.numPoints = numPoints;
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(outlineOffsets), (numOutlines + 1) * sizeof(std::int64_t));
+	file.write(reinterpret_cast<const char*>(indexBoxes.data()), indexBoxes.size() * sizeof(Box));
+	file.write(reinterpret_cast<const char*>(leafOrder.data()), leafOrder.size() * sizeof(std::int64_t));
+	file.write(static_cast<const char*>(coords), numPoints * 2 * GetScalarSize(scalarType));
+
+	return file.good();
+}
@@ -0,0 +1,89 @@
+#ifndef _BINARY_POLY_FILE_H_
+#define _BINARY_POLY_FILE_H_
+
+#include <string>
+#include <cstdint>
+#include <Math/vec2.h>
+#include "Triangulator.h"
+#include "MappedFile.h"
+
+
+// Polygon in the binary .bpoly format, read in place from a memory mapping. All values are little-endian:
+//   header:      char magic[4] = "BPLY", uint16 version, uint16 scalar type, int64 outlines, int64 points
+//   offsets:     int64[outlines + 1], index of the first point of each outline followed by the number of points
+//   index:       float[nodes][4] bounding boxes as min x, min y, max x, max y, then int64[outlines] leaf order
+//   coordinates: x, y pairs of the scalar type
+// The sections are 8-byte aligned, so the offsets and the coordinates can be used directly from the mapping.
+// The index, which version 1 files don't have, is a packed R-tree over the outline bounding boxes. Its leaves are
+// the outlines sorted along a Hilbert curve through their centers, each level above holds the boxes of groups of
+// IndexNodeSize nodes of the level below, up to the single root box at the end. Leaf i is outline leafOrder[i].
+// A rectangle query reads only the index and the outlines it finds, the other pages of the file stay untouched.
+class BinaryPolyFile
+{
+public:
+	enum class ScalarType : std::uint16_t
+	{
+		Float,
+		Double,
+	};
+
+	static constexpr char Magic[4] = { 'B', 'P', 'L', 'Y' };
+	static constexpr std::uint16_t Version = 2;	// Version 1 files, without the index, are read as well.
+	static constexpr index_t IndexNodeSize = 16;
+
+	// Empty outlines have an empty box, with min above max.
+	struct Box
+	{
+		math3d::vec2f min;
+		math3d::vec2f max;
+	};
+
+	// Fails if the file is not a valid .bpoly file. Random access suits reading only the outlines found by FindOutlines.
+	bool Open(const std::string& fileName, MappedFile::Access access = MappedFile::Access::Sequential);
+	void Close();
+
+	ScalarType GetScalarType() const { return _scalarType; }
+	index_t GetNumOutlines() const { return _numOutlines; }
+	index_t GetNumPoints() const { return _numPoints; }
+	const std::int64_t* GetOutlineOffsets() const { return _outlineOffsets; }
+	// Coordinates in the mapping, nullptr if the file has the other scalar type.
+	const math3d::vec2f* GetFloatCoords() const;
+	const math3d::vec2d* GetDoubleCoords() const;
+
+	bool HasIndex() const { return _indexBoxes != nullptr; }
+
+	// Copy of the polygon, double coordinates are rounded to float.
+	void GetOutlines(OutlineList& outOutlines) const;
+	// Copies of the given outlines, appended in the given order.
+	void GetOutlines(const IndexList& outlineIndices, OutlineList& outOutlines) const;
+	// The outlines whose bounding boxes intersect the rectangle, in file order. Without an index all outlines are scanned.
+	void FindOutlines(const Box& rect, IndexList& outOutlineIndices) const;
+
+	// True if the file starts with the magic, whatever follows.
+	static bool IsBinaryPolyFile(const std::string& fileName);
+
+	static bool Save(const std::string& fileName, const OutlineList& outlines);
+	// Lossless for sources with double coordinates. The offsets are laid out as in the file.
+	static bool Save(const std::string& fileName, const std::vector<math3d::vec2d>& pointCoords, const IndexList& outlineOffsets);
+
+private:
+	static bool Save(const std::string& fileName, ScalarType scalarType, index_t numOutlines, index_t numPoints,
+		const std::int64_t* outlineOffsets, const void* coords, const std::vector<Box>& outlineBoxes);
+	// Number of boxes in the index of numOutlines outlines, all levels together.
+	static index_t GetNumIndexNodes(index_t numOutlines);
+	static void BuildIndex(const std::vector<Box>& outlineBoxes, std::vector<Box>& outNodes, std::vector<std::int64_t>& outLeafOrder);
+
+	Box GetOutlineBox(index_t outlineIndex) const;
+	void AppendOutline(index_t outlineIndex, OutlineList& outOutlines) const;
+
+	MappedFile _file;
+	ScalarType _scalarType = ScalarType::Float;
+	index_t _numOutlines = 0;
+	index_t _numPoints = 0;
+	const std::int64_t* _outlineOffsets = nullptr;
+	const void* _coords = nullptr;
+	const Box* _indexBoxes = nullptr;			// nullptr for version 1 files.
+	const std::int64_t* _leafOrder = nullptr;
+};
+
+#endif // _BINARY_POLY_FILE_H_
@@ -0,0 +1,82 @@
+#ifndef _BUFFERED_WRITER_H_
+#define _BUFFERED_WRITER_H_
+
+#include <ostream>
+#include <vector>
+#include <charconv>
+#include <cstring>
+#include "Common.h"
+
+
+// Formats numbers with std::to_chars into a large buffer, which is written to the stream whenever it fills up.
+// Binary values are collected the same way. Flush() has to be called at the end.
+class BufferedWriter
+{
+public:
+	BufferedWriter(std::ostream& stream)
+		: _stream(stream), _buffer(BufferSize), _pos(0)
+	{
+	}
+
+	template <class _T>
+	void Write(_T value)
+	{
+		Reserve(MaxNumberLength);
+		_pos = std::to_chars(_buffer.data() + _pos, _buffer.data() + _buffer.size(), value).ptr - _buffer.data();
+	}
+
+	void Write(char c)
+	{
+		Reserve(1);
+		_buffer[_pos++] = c;
+	}
+
+	void Write(const char* str)
+	{
+		WriteBytes(str, std::strlen(str));
+	}
+
+	// The value in the byte order of the machine.
+	template <class _T>
+	void WriteBinary(const _T& value)
+	{
+		WriteBytes(&value, sizeof(value));
+	}
+
+	void WriteBytes(const void* data, index_t size)
+	{
+		// Data larger than the buffer goes to the stream directly.
+		Reserve(size);
+		if (size > BufferSize)
+		{
+			_stream.write(static_cast<const char*>(data), size);
+			return;
+		}
+
+		std::memcpy(_buffer.data() + _pos, data, size);
+		_pos += size;
+	}
+
+	bool Flush()
+	{
+		_stream.write(_buffer.data(), _pos);
+		_pos = 0;
+		return _stream.good();
+	}
+
+private:
+	static const index_t BufferSize = index_t(1) << 20;
+	static const index_t MaxNumberLength = 32;		// Longest float or integer std::to_chars can produce.
+
+	void Reserve(index_t length)
+	{
+		if (_pos + length > BufferSize)
+			Flush();
+	}
+
+	std::ostream& _stream;
+	std::vector<char> _buffer;
+	index_t _pos;
+};
+
+#endif // _BUFFERED_WRITER_H_
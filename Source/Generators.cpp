@@ -0,0 +1,250 @@
+#include "Generators.h"
+#include <cmath>
+#include <random>
+#include <algorithm>
+
+static const double Pi = 3.14159265358979323846;
+
+// Random radii around the origin at strictly increasing angles. Each vertex gets its own angular slot,
+// so that no two vertices come too close even for millions of vertices.
+static void GenerateStar(int_t numVertices, std::mt19937& rndEng, OutlineList& outOutlines)
+{
+	std::uniform_real_distribution<double> dist(0.0, 1.0);
+	index_t n = std::max<int_t>(numVertices, 3);
+	double scale = static_cast<double>(n);
+	Outline outline(n);
+
+	for (index_t i = 0; i < n; ++i)
+	{
+		double angle = 2.0 * Pi * (i + 0.8 * dist(rndEng)) / n;
+		double radius = scale * (0.2 + 0.8 * dist(rndEng));
+		outline[i] = { static_cast<float>(radius * std::cos(angle)), static_cast<float>(radius * std::sin(angle)) };
+	}
+
+	outOutlines.push_back(std::move(outline));
+}
+
+// Strip between two Archimedean spirals, the inner one traversed outward and the outer one back.
+static void GenerateSpiral(int_t numVertices, std::mt19937& rndEng, OutlineList& outOutlines)
+{
+	std::uniform_real_distribution<double> dist(-0.1, 0.1);
+	index_t m = std::max<int_t>(numVertices / 2, 8);
+	double turns = std::max(1.0, std::sqrt(static_cast<double>(m)) / 8.0);
+	double spacing = 2.0 * Pi;			// Distance between neighbouring windings.
+	double width = 0.5 * spacing;
+	double scale = static_cast<double>(m) / (spacing * (turns + 1.0));
+	Outline outline(2 * m);
+
+	for (index_t i = 0; i < m; ++i)
+	{
+		double t = 2.0 * Pi * turns * i / (m - 1);
+		double radius = spacing + t;
+		double innerRadius = radius + dist(rndEng) * width;
+		double outerRadius = radius + width + dist(rndEng) * width;
+		double c = std::cos(t);
+		double s = std::sin(t);
+
+		outline[i] = { static_cast<float>(scale * innerRadius * c), static_cast<float>(scale * innerRadius * s) };
+		outline[2 * m - 1 - i] = { static_cast<float>(scale * outerRadius * c), static_cast<float>(scale * outerRadius * s) };
+	}
+
+	outOutlines.push_back(std::move(outline));
+}
+
+// Teeth of width 1 with gaps of width 1 between them, standing on a base of height 1.
+static void GenerateComb(int_t numVertices, std::mt19937& rndEng, OutlineList& outOutlines)
+{
+	index_t numTeeth = std::max<int_t>(numVertices / 4, 1);
+	std::uniform_real_distribution<float> dist(2.0f, 2.0f + numTeeth);
+	float right = static_cast<float>(2 * numTeeth - 1);
+	Outline outline;
+	outline.reserve(4 * numTeeth);
+
+	outline.push_back({ 0.0f, 0.0f });
+	outline.push_back({ right, 0.0f });
+
+	for (index_t j = numTeeth - 1; j >= 0; --j)
+	{
+		float x = static_cast<float>(2 * j);
+		float height = dist(rndEng);
+		outline.push_back({ x + 1.0f, height });
+		outline.push_back({ x, height });
+
+		if (j > 0)
+		{
+			outline.push_back({ x, 1.0f });
+			outline.push_back({ x - 1.0f, 1.0f });
+		}
+	}
+
+	outOutlines.push_back(std::move(outline));
+}
+
+// Cell coordinates of the d-th cell along the Hilbert curve that fills a size x size grid.
+static void HilbertCell(int_t size, int_t d, int_t& x, int_t& y)
+{
+	x = y = 0;
+	for (int_t s = 1; s < size; s *= 2)
+	{
+		int_t rx = 1 & (d / 2);
+		int_t ry = 1 & (d ^ rx);
+
+		if (ry == 0)
+		{
+			if (rx == 1)
+			{
+				x = s - 1 - x;
+				y = s - 1 - y;
+			}
+			std::swap(x, y);
+		}
+
+		x += s * rx;
+		y += s * ry;
+		d /= 4;
+	}
+}
+
+// Outline of the Hilbert curve path thickened to half the grid spacing. Only the turns of the path become vertices,
+// each moved by a small random offset that keeps the gaps between neighbouring strips open.
+static void GenerateHilbert(int_t numVertices, std::mt19937& rndEng, OutlineList& outOutlines)
+{
+	const float halfWidth = 0.25f;
+	std::uniform_real_distribution<float> dist(-0.05f, 0.05f);
+
+	for (int_t size = 2; ; size *= 2)
+	{
+		int_t numCells = size * size;
+		std::vector<math3d::vec2f> path(numCells);
+		for (int_t d = 0; d < numCells; ++d)
+		{
+			int_t x, y;
+			HilbertCell(size, d, x, y);
+			path[d] = { static_cast<float>(x), static_cast<float>(y) };
+		}
+
+		Outline left;
+		Outline right;
+		auto leftNormal = [](const math3d::vec2f& dir) { return math3d::vec2f(-dir.y, dir.x); };
+
+		math3d::vec2f firstDir = path[1] - path[0];
+		left.push_back(path[0] + halfWidth * (leftNormal(firstDir) - firstDir));
+		right.push_back(path[0] - halfWidth * (leftNormal(firstDir) + firstDir));
+
+		for (index_t i = 1; i + 1 < numCells; ++i)
+		{
+			math3d::vec2f prevDir = path[i] - path[i - 1];
+			math3d::vec2f nextDir = path[i + 1] - path[i];
+			if (prevDir == nextDir)
+				continue;
+
+			math3d::vec2f miter = halfWidth * (leftNormal(prevDir) + leftNormal(nextDir));
+			left.push_back(path[i] + miter);
+			right.push_back(path[i] - miter);
+		}
+
+		math3d::vec2f lastDir = path[numCells - 1] - path[numCells - 2];
+		left.push_back(path[numCells - 1] + halfWidth * (leftNormal(lastDir) + lastDir));
+		right.push_back(path[numCells - 1] - halfWidth * (leftNormal(lastDir) - lastDir));
+
+		if (left.size() + right.size() >= numVertices)
+		{
+			for (auto& pt : left)
+				pt += math3d::vec2f(dist(rndEng), dist(rndEng));
+			for (auto& pt : right)
+				pt += math3d::vec2f(dist(rndEng), dist(rndEng));
+
+			left.insert(left.end(), right.rbegin(), right.rend());
+			outOutlines.push_back(std::move(left));
+			return;
+		}
+	}
+}
+
+// Unit square cells, each but the surplus ones with an octagonal hole of random size and position.
+static void GenerateHoles(int_t numVertices, std::mt19937& rndEng, OutlineList& outOutlines)
+{
+	const index_t holeVertices = 8;
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	index_t numHoles = std::max<int_t>((numVertices - 4) / holeVertices, 1);
+	index_t gridSize = static_cast<index_t>(std::ceil(std::sqrt(static_cast<double>(numHoles))));
+	float side = static_cast<float>(gridSize);
+
+	outOutlines.push_back({ { 0.0f, 0.0f }, { side, 0.0f }, { side, side }, { 0.0f, side } });
+
+	for (index_t h = 0; h < numHoles; ++h)
+	{
+		math3d::vec2f center = {
+			static_cast<float>(h % gridSize) + 0.5f + 0.1f * dist(rndEng),
+			static_cast<float>(h / gridSize) + 0.5f + 0.1f * dist(rndEng) };
+		Outline hole(holeVertices);
+
+		// Clockwise, opposite to the outer square.
+		for (index_t i = 0; i < holeVertices; ++i)
+		{
+			double angle = -2.0 * Pi * (i + 0.3 * dist(rndEng)) / holeVertices;
+			float radius = 0.3f + 0.05f * dist(rndEng);
+			hole[i] = center + radius * math3d::vec2f(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+		}
+
+		outOutlines.push_back(std::move(hole));
+	}
+}
+
+const char* GetGeneratorName(GeneratorType type)
+{
+	switch (type)
+	{
+	case GeneratorType::Star:
+		return "star";
+	case GeneratorType::Spiral:
+		return "spiral";
+	case GeneratorType::Comb:
+		return "comb";
+	case GeneratorType::Hilbert:
+		return "hilbert";
+	case GeneratorType::Holes:
+		return "holes";
+	}
+
+	return "";
+}
+
+bool ParseGeneratorType(const std::string& name, GeneratorType& type)
+{
+	for (auto t : { GeneratorType::Star, GeneratorType::Spiral, GeneratorType::Comb, GeneratorType::Hilbert, GeneratorType::Holes })
+	{
+		if (name == GetGeneratorName(t))
+		{
+			type = t;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void GeneratePolygon(GeneratorType type, int_t numVertices, std::uint32_t seed, OutlineList& outOutlines)
+{
+	std::mt19937 rndEng(seed);
+	outOutlines.clear();
+
+	switch (type)
+	{
+	case GeneratorType::Star:
+		GenerateStar(numVertices, rndEng, outOutlines);
+		break;
+	case GeneratorType::Spiral:
+		GenerateSpiral(numVertices, rndEng, outOutlines);
+		break;
+	case GeneratorType::Comb:
+		GenerateComb(numVertices, rndEng, outOutlines);
+		break;
+	case GeneratorType::Hilbert:
+		GenerateHilbert(numVertices, rndEng, outOutlines);
+		break;
+	case GeneratorType::Holes:
+		GenerateHoles(numVertices, rndEng, outOutlines);
+		break;
+	}
+}
@@ -0,0 +1,24 @@
+#ifndef _GENERATORS_H_
+#define _GENERATORS_H_
+
+#include <string>
+#include <cstdint>
+#include "Triangulator.h"
+
+// Synthetic simple polygons for scaling studies. The same type, vertex count and seed always give the same polygon.
+enum class GeneratorType
+{
+	Star,		// Star-shaped polygon with random radii.
+	Spiral,		// Thin strip wound into a spiral.
+	Comb,		// Row of teeth with random heights on a common base.
+	Hilbert,	// Thickened Hilbert curve, the vertex count is rounded up to the next curve order.
+	Holes,		// Square with a grid of small random holes.
+};
+
+const char* GetGeneratorName(GeneratorType type);
+bool ParseGeneratorType(const std::string& name, GeneratorType& type);
+
+// Generate a polygon with about numVertices vertices.
+void GeneratePolygon(GeneratorType type, int_t numVertices, std::uint32_t seed, OutlineList& outOutlines);
+
+#endif // _GENERATORS_H_
@@ -0,0 +1,727 @@
+#include "GeoImport.h"
+#include <charconv>
+#include <cstring>
+#include <cctype>
+#include <filesystem>
+#include <string_view>
+#include <Math/vec2.h>
+#include "MappedFile.h"
+
+// Deeper nesting than this is rejected, so that malformed files can't exhaust the stack.
+static const int MaxNestingDepth = 256;
+
+// Rings in double precision, one after another, with the index of the first point of each ring.
+struct RingCollector
+{
+	std::vector<math3d::vec2d> points;
+	IndexList offsets { 0 };
+
+	void AddPoint(double x, double y)
+	{
+		points.push_back({ x, y });
+	}
+
+	// Drops the closing vertex if it repeats the first one. Empty rings are dropped entirely.
+	void EndRing()
+	{
+		index_t first = offsets.back();
+		if (points.size() - first > 1 && points.back() == points[first])
+			points.pop_back();
+
+		if (points.size() > first)
+			offsets.push_back(points.size());
+	}
+
+	void Append(const RingCollector& other)
+	{
+		index_t base = points.size();
+		points.insert(points.end(), other.points.begin(), other.points.end());
+		for (index_t r = 1; r < other.offsets.size(); ++r)
+			offsets.push_back(base + other.offsets[r]);
+	}
+};
+
+// Position in a text file.
+struct TextCursor
+{
+	const char* begin;
+	const char* pos;
+	const char* end;
+};
+
+static void SkipSpace(TextCursor& c)
+{
+	while (c.pos < c.end && std::isspace(static_cast<unsigned char>(*c.pos)))
+		++c.pos;
+}
+
+// Next character after white space, 0 at the end of the file.
+static char PeekChar(TextCursor& c)
+{
+	SkipSpace(c);
+	return (c.pos < c.end) ? *c.pos : 0;
+}
+
+static bool ExpectChar(TextCursor& c, char ch)
+{
+	if (PeekChar(c) != ch)
+		return false;
+
+	++c.pos;
+	return true;
+}
+
+static bool ParseNumber(TextCursor& c, double& value)
+{
+	SkipSpace(c);
+	auto result = std::from_chars(c.pos, c.end, value);
+	if (result.ec != std::errc())
+		return false;
+
+	c.pos = result.ptr;
+	return true;
+}
+
+// GeoJSON
+
+// The raw contents between the quotes, escapes are left as they are.
+static bool ParseJsonString(TextCursor& c, std::string_view& str)
+{
+	if (!ExpectChar(c, '"'))
+		return false;
+
+	const char* start = c.pos;
+	while (c.pos < c.end && *c.pos != '"')
+		c.pos += (*c.pos == '\\') ? 2 : 1;
+
+	if (c.pos >= c.end)
+		return false;
+
+	str = std::string_view(start, c.pos - start);
+	++c.pos;
+	return true;
+}
+
+// [x, y, ...], the coordinates after the second one are ignored.
+static bool ParseJsonPosition(TextCursor& c, double& x, double& y)
+{
+	if (!ExpectChar(c, '[') || !ParseNumber(c, x) || !ExpectChar(c, ',') || !ParseNumber(c, y))
+		return false;
+
+	double ignored;
+	while (ExpectChar(c, ','))
+	{
+		if (!ParseNumber(c, ignored))
+			return false;
+	}
+
+	return ExpectChar(c, ']');
+}
+
+// Any nesting of coordinate arrays. Every array of positions is taken as a ring, the geometry type decides
+// afterwards whether they are kept.
+static bool ParseJsonCoordinates(TextCursor& c, RingCollector& rings, int depth)
+{
+	if (depth > MaxNestingDepth)
+		return false;
+
+	const char* start = c.pos;
+	if (!ExpectChar(c, '['))
+		return false;
+
+	char next = PeekChar(c);
+	if (next == ']')
+	{
+		++c.pos;
+		return true;
+	}
+
+	if (next != '[')
+	{
+		// A single position, as in a Point.
+		double x, y;
+		c.pos = start;
+		return ParseJsonPosition(c, x, y);
+	}
+
+	// An array of arrays, a ring if the inner arrays hold numbers.
+	TextCursor lookAhead = c;
+	++lookAhead.pos;
+	next = PeekChar(lookAhead);
+	bool isRing = (next != '[' && next != ']');
+
+	do
+	{
+		if (isRing)
+		{
+			double x, y;
+			if (!ParseJsonPosition(c, x, y))
+				return false;
+
+			rings.AddPoint(x, y);
+		}
+		else if (!ParseJsonCoordinates(c, rings, depth + 1))
+			return false;
+	}
+	while (ExpectChar(c, ','));
+
+	if (isRing)
+		rings.EndRing();
+
+	return ExpectChar(c, ']');
+}
+
+static bool ParseJsonValue(TextCursor& c, RingCollector& outRings, int depth);
+
+// The rings of a Polygon or MultiPolygon object are added to outRings, nested objects are searched as well.
+static bool ParseJsonObject(TextCursor& c, RingCollector& outRings, int depth)
+{
+	if (depth > MaxNestingDepth || !ExpectChar(c, '{'))
+		return false;
+
+	std::string_view type;
+	RingCollector coordinates;
+	bool hasCoordinates = false;
+
+	if (ExpectChar(c, '}'))
+		return true;
+
+	do
+	{
+		std::string_view key;
+		if (!ParseJsonString(c, key) || !ExpectChar(c, ':'))
+			return false;
+
+		if (key == "type" && PeekChar(c) == '"')
+		{
+			if (!ParseJsonString(c, type))
+				return false;
+		}
+		else if (key == "coordinates" && PeekChar(c) == '[')
+		{
+			coordinates = RingCollector();
+			hasCoordinates = true;
+			if (!ParseJsonCoordinates(c, coordinates, depth + 1))
+				return false;
+		}
+		else if (!ParseJsonValue(c, outRings, depth + 1))
+			return false;
+	}
+	while (ExpectChar(c, ','));
+
+	if (!ExpectChar(c, '}'))
+		return false;
+
+	if (hasCoordinates && (type == "Polygon" || type == "MultiPolygon"))
+		outRings.Append(coordinates);
+
+	return true;
+}
+
+static bool ParseJsonValue(TextCursor& c, RingCollector& outRings, int depth)
+{
+	if (depth > MaxNestingDepth)
+		return false;
+
+	char next = PeekChar(c);
+	if (next == '{')
+		return ParseJsonObject(c, outRings, depth);
+
+	if (next == '[')
+	{
+		++c.pos;
+		if (ExpectChar(c, ']'))
+			return true;
+
+		do
+		{
+			if (!ParseJsonValue(c, outRings, depth + 1))
+				return false;
+		}
+		while (ExpectChar(c, ','));
+
+		return ExpectChar(c, ']');
+	}
+
+	if (next == '"')
+	{
+		std::string_view str;
+		return ParseJsonString(c, str);
+	}
+
+	if (next == '-' || std::isdigit(static_cast<unsigned char>(next)))
+	{
+		double value;
+		return ParseNumber(c, value);
+	}
+
+	// true, false or null.
+	const char* start = c.pos;
+	while (c.pos < c.end && std::isalpha(static_cast<unsigned char>(*c.pos)))
+		++c.pos;
+
+	return c.pos > start;
+}
+
+static bool ImportGeoJSON(TextCursor& c, RingCollector& outRings)
+{
+	if (!ParseJsonValue(c, outRings, 0))
+		return false;
+
+	SkipSpace(c);
+	return c.pos == c.end;
+}
+
+// WKT
+
+// Upper-case keyword, empty if there is none.
+static std::string ParseWktWord(TextCursor& c)
+{
+	SkipSpace(c);
+	std::string word;
+	while (c.pos < c.end && std::isalpha(static_cast<unsigned char>(*c.pos)))
+		word += static_cast<char>(std::toupper(static_cast<unsigned char>(*c.pos++)));
+
+	return word;
+}
+
+// Skips the Z, M or ZM after the geometry type. Returns true if the geometry is EMPTY.
+static bool ParseWktDimensions(TextCursor& c)
+{
+	const char* start = c.pos;
+	std::string word = ParseWktWord(c);
+	if (word == "Z" || word == "M" || word == "ZM")
+	{
+		start = c.pos;
+		word = ParseWktWord(c);
+	}
+
+	if (word == "EMPTY")
+		return true;
+
+	c.pos = start;
+	return false;
+}
+
+// (x y ..., x y ..., ...), the coordinates after the second one are ignored.
+static bool ParseWktRing(TextCursor& c, RingCollector& rings)
+{
+	if (!ExpectChar(c, '('))
+		return false;
+
+	do
+	{
+		double x, y;
+		if (!ParseNumber(c, x) || !ParseNumber(c, y))
+			return false;
+
+		double ignored;
+		while (PeekChar(c) != ',' && PeekChar(c) != ')')
+		{
+			if (!ParseNumber(c, ignored))
+				return false;
+		}
+
+		rings.AddPoint(x, y);
+	}
+	while (ExpectChar(c, ','));
+
+	rings.EndRing();
+	return ExpectChar(c, ')');
+}
+
+// Rings of one polygon, or polygons of a multipolygon if nested.
+static bool ParseWktRingList(TextCursor& c, RingCollector& rings, bool nested)
+{
+	if (!ExpectChar(c, '('))
+		return false;
+
+	do
+	{
+		const char* start = c.pos;
+		if (ParseWktWord(c) == "EMPTY")
+			continue;
+
+		c.pos = start;
+		if (!(nested ? ParseWktRingList(c, rings, false) : ParseWktRing(c, rings)))
+			return false;
+	}
+	while (ExpectChar(c, ','));
+
+	return ExpectChar(c, ')');
+}
+
+static bool SkipWktParentheses(TextCursor& c)
+{
+	if (!ExpectChar(c, '('))
+		return false;
+
+	for (int depth = 1; depth > 0; ++c.pos)
+	{
+		if (c.pos >= c.end)
+			return false;
+
+		if (*c.pos == '(')
+			++depth;
+		else if (*c.pos == ')')
+			--depth;
+	}
+
+	return true;
+}
+
+// Geometries one after another, optionally with the SRID=n; prefix of EWKT.
+static bool ImportWKT(TextCursor& c, RingCollector& outRings)
+{
+	int numOpenCollections = 0;
+
+	while (PeekChar(c) != 0)
+	{
+		char next = *c.pos;
+		if ((next == ',' || next == ')') && numOpenCollections > 0)
+		{
+			numOpenCollections -= (next == ')') ? 1 : 0;
+			++c.pos;
+			continue;
+		}
+
+		std::string word = ParseWktWord(c);
+		if (word == "SRID")
+		{
+			while (c.pos < c.end && *c.pos != ';')
+				++c.pos;
+			if (c.pos++ >= c.end)
+				return false;
+			continue;
+		}
+
+		if (word.empty())
+			return false;
+
+		if (ParseWktDimensions(c))
+			continue;
+
+		if (word == "POLYGON")
+		{
+			if (!ParseWktRingList(c, outRings, false))
+				return false;
+		}
+		else if (word == "MULTIPOLYGON")
+		{
+			if (!ParseWktRingList(c, outRings, true))
+				return false;
+		}
+		else if (word == "GEOMETRYCOLLECTION")
+		{
+			if (!ExpectChar(c, '('))
+				return false;
+			++numOpenCollections;
+		}
+		else if (word == "POINT" || word == "LINESTRING" || word == "MULTIPOINT" || word == "MULTILINESTRING")
+		{
+			if (!SkipWktParentheses(c))
+				return false;
+		}
+		else
+			return false;
+	}
+
+	return numOpenCollections == 0;
+}
+
+// WKB
+
+enum WkbType
+{
+	WkbPoint = 1,
+	WkbLineString,
+	WkbPolygon,
+	WkbMultiPoint,
+	WkbMultiLineString,
+	WkbMultiPolygon,
+	WkbGeometryCollection,
+};
+
+// Flags of the extended WKB of PostGIS.
+static const std::uint32_t EwkbZ = 0x80000000u;
+static const std::uint32_t EwkbM = 0x40000000u;
+static const std::uint32_t EwkbSrid = 0x20000000u;
+
+// Position in a WKB stream, with the byte order of the current geometry.
+struct WkbCursor
+{
+	const unsigned char* pos;
+	const unsigned char* end;
+	bool swap = false;		// The geometry's byte order differs from the machine's.
+};
+
+static bool IsLittleEndianMachine()
+{
+	const std::uint16_t one = 1;
+	unsigned char firstByte;
+	std::memcpy(&firstByte, &one, 1);
+	return firstByte == 1;
+}
+
+template <class _T>
+static bool ReadWkbValue(WkbCursor& c, _T& value)
+{
+	if (c.end - c.pos < static_cast<index_t>(sizeof(_T)))
+		return false;
+
+	unsigned char bytes[sizeof(_T)];
+	std::memcpy(bytes, c.pos, sizeof(_T));
+	if (c.swap)
+	{
+		for (size_t i = 0; i < sizeof(_T) / 2; ++i)
+			std::swap(bytes[i], bytes[sizeof(_T) - 1 - i]);
+	}
+
+	std::memcpy(&value, bytes, sizeof(_T));
+	c.pos += sizeof(_T);
+	return true;
+}
+
+// Fails if fewer than count points of numDims doubles are left.
+static bool CheckWkbPoints(const WkbCursor& c, std::uint32_t count, int numDims)
+{
+	return static_cast<std::uint64_t>(c.end - c.pos) / (numDims * sizeof(double)) >= count;
+}
+
+static bool ParseWkbGeometry(WkbCursor& c, RingCollector& outRings, int depth)
+{
+	std::uint8_t byteOrder;
+	std::uint32_t type;
+	if (depth > MaxNestingDepth || !ReadWkbValue(c, byteOrder) || byteOrder > 1)
+		return false;
+
+	c.swap = ((byteOrder == 1) != IsLittleEndianMachine());
+	if (!ReadWkbValue(c, type))
+		return false;
+
+	// The Z and M flags of EWKB, or the 1000, 2000 and 3000 type offsets of ISO WKB.
+	int numDims = 2 + ((type & EwkbZ) ? 1 : 0) + ((type & EwkbM) ? 1 : 0);
+	std::uint32_t srid;
+	if ((type & EwkbSrid) && !ReadWkbValue(c, srid))
+		return false;
+
+	type &= 0x0fffffffu;
+	if (type / 1000 > 0)
+		numDims = (type / 1000 == 3) ? 4 : 3;
+	type %= 1000;
+
+	std::uint32_t count;
+	switch (type)
+	{
+	case WkbPoint:
+		if (!CheckWkbPoints(c, 1, numDims))
+			return false;
+		c.pos += numDims * sizeof(double);
+		return true;
+
+	case WkbLineString:
+		if (!ReadWkbValue(c, count) || !CheckWkbPoints(c, count, numDims))
+			return false;
+		c.pos += count * numDims * sizeof(double);
+		return true;
+
+	case WkbPolygon:
+		if (!ReadWkbValue(c, count))
+			return false;
+
+		for (std::uint32_t r = 0; r < count; ++r)
+		{
+			std::uint32_t numPoints;
+			if (!ReadWkbValue(c, numPoints) || !CheckWkbPoints(c, numPoints, numDims))
+				return false;
+
+			for (std::uint32_t i = 0; i < numPoints; ++i)
+			{
+				double x, y;
+				ReadWkbValue(c, x);
+				ReadWkbValue(c, y);
+				c.pos += (numDims - 2) * sizeof(double);
+				outRings.AddPoint(x, y);
+			}
+
+			outRings.EndRing();
+		}
+		return true;
+
+	case WkbMultiPoint:
+	case WkbMultiLineString:
+	case WkbMultiPolygon:
+	case WkbGeometryCollection:
+		if (!ReadWkbValue(c, count))
+			return false;
+
+		for (std::uint32_t g = 0; g < count; ++g)
+		{
+			if (!ParseWkbGeometry(c, outRings, depth + 1))
+				return false;
+		}
+		return true;
+	}
+
+	return false;
+}
+
+static int HexDigitValue(char ch)
+{
+	if (ch >= '0' && ch <= '9')
+		return ch - '0';
+	if (ch >= 'a' && ch <= 'f')
+		return ch - 'a' + 10;
+	if (ch >= 'A' && ch <= 'F')
+		return ch - 'A' + 10;
+	return -1;
+}
+
+// Hex-encoded WKB, white space between the geometries is allowed.
+static bool DecodeHex(const char* data, index_t size, std::vector<unsigned char>& outBytes)
+{
+	int high = -1;
+	for (index_t i = 0; i < size; ++i)
+	{
+		if (std::isspace(static_cast<unsigned char>(data[i])))
+			continue;
+
+		int value = HexDigitValue(data[i]);
+		if (value < 0)
+			return false;
+
+		if (high < 0)
+			high = value;
+		else
+		{
+			outBytes.push_back(static_cast<unsigned char>(16 * high + value));
+			high = -1;
+		}
+	}
+
+	return high < 0;
+}
+
+static bool ImportWKB(const char* data, index_t size, RingCollector& outRings)
+{
+	// Binary WKB starts with the byte order 0 or 1, the hex encoding of it with the digit '0'.
+	std::vector<unsigned char> decoded;
+	WkbCursor c;
+	c.pos = reinterpret_cast<const unsigned char*>(data);
+	c.end = c.pos + size;
+
+	if (size > 0 && data[0] == '0')
+	{
+		if (!DecodeHex(data, size, decoded))
+			return false;
+
+		c.pos = decoded.data();
+		c.end = c.pos + decoded.size();
+	}
+
+	while (c.pos < c.end)
+	{
+		if (!ParseWkbGeometry(c, outRings, 0))
+			return false;
+	}
+
+	return true;
+}
+
+const char* GetGeoFormatName(GeoFormat format)
+{
+	switch (format)
+	{
+	case GeoFormat::GeoJSON:
+		return "geojson";
+	case GeoFormat::WKT:
+		return "wkt";
+	case GeoFormat::WKB:
+		return "wkb";
+	}
+
+	return "";
+}
+
+bool GetGeoFormatOfFile(const std::string& fileName, GeoFormat& format)
+{
+	auto extension = std::filesystem::path(fileName).extension().string();
+	if (extension == ".json")
+	{
+		format = GeoFormat::GeoJSON;
+		return true;
+	}
+
+	for (auto f : { GeoFormat::GeoJSON, GeoFormat::WKT, GeoFormat::WKB })
+	{
+		if (extension == std::string(".") + GetGeoFormatName(f))
+		{
+			format = f;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool ImportGeoFile(const std::string& fileName, GeoFormat format, const GeoImportOptions& options, OutlineList& outOutlines, std::string& errDesc)
+{
+	outOutlines.clear();
+
+	MappedFile file;
+	if (!file.Open(fileName))
+	{
+		errDesc = "Failed to open " + fileName + ".";
+		return false;
+	}
+
+	RingCollector rings;
+	TextCursor text { file.GetData(), file.GetData(), file.GetData() + file.GetSize() };
+	bool parsed = false;
+
+	switch (format)
+	{
+	case GeoFormat::GeoJSON:
+		parsed = ImportGeoJSON(text, rings);
+		break;
+	case GeoFormat::WKT:
+		parsed = ImportWKT(text, rings);
+		break;
+	case GeoFormat::WKB:
+		parsed = ImportWKB(file.GetData(), file.GetSize(), rings);
+		break;
+	}
+
+	if (!parsed)
+	{
+		errDesc = "Invalid " + std::string(GetGeoFormatName(format)) + " file";
+		if (format != GeoFormat::WKB)
+			errDesc += ", error at byte " + std::to_string(text.pos - text.begin);
+		errDesc += ".";
+		return false;
+	}
+
+	// The mean is subtracted before scaling, so that far-off coordinates keep their precision.
+	math3d::vec2d mean(0.0, 0.0);
+	if (options.center && !rings.points.empty())
+	{
+		for (const auto& pt : rings.points)
+			mean += pt;
+		mean /= static_cast<double>(rings.points.size());
+	}
+
+	outOutlines.resize(rings.offsets.size() - 1);
+	for (index_t r = 0; r < outOutlines.size(); ++r)
+	{
+		auto& outline = outOutlines[r];
+		outline.reserve(rings.offsets[r + 1] - rings.offsets[r]);
+
+		for (index_t i = rings.offsets[r]; i < rings.offsets[r + 1]; ++i)
+		{
+			math3d::vec2d pt = options.scale * (rings.points[i] - mean);
+			outline.push_back({ static_cast<float>(pt.x), static_cast<float>(pt.y) });
+		}
+	}
+
+	return true;
+}
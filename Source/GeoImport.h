@@ -0,0 +1,31 @@
+#ifndef _GEO_IMPORT_H_
+#define _GEO_IMPORT_H_
+
+#include <string>
+#include "Triangulator.h"
+
+
+// Polygons from GIS formats. Only Polygon and MultiPolygon geometries are imported, every ring becomes an outline.
+// Other geometries are skipped, geometry collections and GeoJSON features are searched for polygons.
+enum class GeoFormat
+{
+	GeoJSON,
+	WKT,	// Text, any number of geometries one after another.
+	WKB,	// Binary or hex-encoded, any number of geometries one after another.
+};
+
+struct GeoImportOptions
+{
+	double scale = 1.0;		// Applied before centering.
+	bool center = false;	// Move the mean of all vertices to the origin.
+};
+
+const char* GetGeoFormatName(GeoFormat format);
+// The format is chosen by the .geojson or .json, .wkt or .wkb extension of the file name.
+bool GetGeoFormatOfFile(const std::string& fileName, GeoFormat& format);
+
+// The coordinates are read and transformed in double precision and rounded to float at the end. The closing
+// vertex of a ring, which repeats the first one, is dropped. Z and M values are ignored.
+bool ImportGeoFile(const std::string& fileName, GeoFormat format, const GeoImportOptions& options, OutlineList& outOutlines, std::string& errDesc);
+
+#endif // _GEO_IMPORT_H_
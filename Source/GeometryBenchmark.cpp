@@ -0,0 +1,305 @@
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <algorithm>
+#include <fstream>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <Math/geometry.h>
+#include "Serialization.h"
+
+// Microbenchmark of the geometry predicates used by validation and trapezoidation, in float and double.
+// Each predicate runs over a fixed set of inputs drawn from one of several coordinate distributions.
+
+// Four points per input: segments ab and cd, or point c against segment ab.
+struct InputSet
+{
+	std::string name;
+	std::vector<math3d::vec2d> a, b, c, d;
+};
+
+template <class _ST>
+struct TypedInputs
+{
+	std::vector<math3d::vec2<_ST>> a, b, c, d;
+	std::vector<math3d::vec3<_ST>> lineAB, lineCD;
+};
+
+struct Result
+{
+	std::string predicate;
+	std::string inputSet;
+	double floatNS;
+	double doubleNS;
+};
+
+static const index_t NumInputs = 1 << 16;
+
+// Segments spread over a large area, as in validation, where most pairs don't intersect.
+static InputSet MakeUniformSet(std::mt19937& rndEng)
+{
+	std::uniform_real_distribution<double> dist(-1000.0, 1000.0);
+	InputSet set { "uniform" };
+
+	for (index_t i = 0; i < NumInputs; ++i)
+	{
+		set.a.push_back({ dist(rndEng), dist(rndEng) });
+		set.b.push_back({ dist(rndEng), dist(rndEng) });
+		set.c.push_back({ dist(rndEng), dist(rndEng) });
+		set.d.push_back({ dist(rndEng), dist(rndEng) });
+	}
+
+	return set;
+}
+
+// Short segments far from the origin, like projected map coordinates. Float keeps few fractional bits there.
+static InputSet MakeOffsetSet(std::mt19937& rndEng)
+{
+	std::uniform_real_distribution<double> dist(-10.0, 10.0);
+	const math3d::vec2d offset(1.0e6, 2.0e6);
+	InputSet set { "offset" };
+
+	for (index_t i = 0; i < NumInputs; ++i)
+	{
+		math3d::vec2d center = offset + math3d::vec2d(100.0 * dist(rndEng), 100.0 * dist(rndEng));
+		set.a.push_back(center + math3d::vec2d(dist(rndEng), dist(rndEng)));
+		set.b.push_back(center + math3d::vec2d(dist(rndEng), dist(rndEng)));
+		set.c.push_back(center + math3d::vec2d(dist(rndEng), dist(rndEng)));
+		set.d.push_back(center + math3d::vec2d(dist(rndEng), dist(rndEng)));
+	}
+
+	return set;
+}
+
+// Points within a tiny distance of the segment line, where the orientation is hard to tell.
+static InputSet MakeNearColinearSet(std::mt19937& rndEng)
+{
+	std::uniform_real_distribution<double> dist(-100.0, 100.0);
+	std::uniform_real_distribution<double> paramDist(-0.5, 1.5);
+	std::uniform_real_distribution<double> offsetDist(-1e-5, 1e-5);
+	InputSet set { "near_colinear" };
+
+	for (index_t i = 0; i < NumInputs; ++i)
+	{
+		math3d::vec2d a(dist(rndEng), dist(rndEng));
+		math3d::vec2d b(dist(rndEng), dist(rndEng));
+		math3d::vec2d normal = math3d::rotate_90_ccw_2d(b - a);
+		normal.normalize();
+
+		set.a.push_back(a);
+		set.b.push_back(b);
+		set.c.push_back(a + paramDist(rndEng) * (b - a) + offsetDist(rndEng) * normal);
+		set.d.push_back(a + paramDist(rndEng) * (b - a) + offsetDist(rndEng) * normal);
+	}
+
+	return set;
+}
+
+// Segments of a real polygon paired with segments a few positions further along the outline,
+// which are close but rarely intersect, as in the trapezoidation.
+static bool MakePolygonSet(const std::string& polyFile, std::mt19937& rndEng, InputSet& outSet)
+{
+	OutlineList outlines;
+	if (!LoadPolyFile(polyFile, outlines))
+		return false;
+
+	std::vector<std::pair<math3d::vec2d, math3d::vec2d>> segments;
+	for (const auto& outl : outlines)
+	{
+		for (index_t i = 0; i < outl.size(); ++i)
+		{
+			const auto& start = outl[i];
+			const auto& end = outl[(i + 1) % outl.size()];
+			segments.push_back({ { start.x, start.y }, { end.x, end.y } });
+		}
+	}
+
+	if (segments.size() < 2)
+		return false;
+
+	std::uniform_int_distribution<index_t> segDist(0, segments.size() - 1);
+	std::uniform_int_distribution<index_t> offsetDist(2, 20);
+	outSet = { "polygon" };
+
+	for (index_t i = 0; i < NumInputs; ++i)
+	{
+		index_t s1 = segDist(rndEng);
+		index_t s2 = (s1 + offsetDist(rndEng)) % segments.size();
+		outSet.a.push_back(segments[s1].first);
+		outSet.b.push_back(segments[s1].second);
+		outSet.c.push_back(segments[s2].first);
+		outSet.d.push_back(segments[s2].second);
+	}
+
+	return true;
+}
+
+template <class _ST>
+static void ConvertInputs(const InputSet& set, TypedInputs<_ST>& outInputs)
+{
+	auto convert = [](const std::vector<math3d::vec2d>& points, std::vector<math3d::vec2<_ST>>& outPoints) {
+		outPoints.clear();
+		for (const auto& pt : points)
+			outPoints.push_back({ static_cast<_ST>(pt.x), static_cast<_ST>(pt.y) });
+	};
+
+	convert(set.a, outInputs.a);
+	convert(set.b, outInputs.b);
+	convert(set.c, outInputs.c);
+	convert(set.d, outInputs.d);
+
+	outInputs.lineAB.clear();
+	outInputs.lineCD.clear();
+	for (index_t i = 0; i < NumInputs; ++i)
+	{
+		outInputs.lineAB.push_back(math3d::line_from_points_2d(outInputs.a[i], outInputs.b[i]));
+		outInputs.lineCD.push_back(math3d::line_from_points_2d(outInputs.c[i], outInputs.d[i]));
+	}
+}
+
+// Nanoseconds per call, the best of several repetitions. The results are summed into a sink, so that
+// the calls can't be removed.
+template <class _Func>
+static double MeasureNS(_Func func)
+{
+	const int numRepetitions = 7;
+	volatile int_t sink = 0;
+	double bestNS = std::numeric_limits<double>::max();
+
+	for (int r = 0; r < numRepetitions; ++r)
+	{
+		int_t sum = 0;
+		auto startTime = std::chrono::high_resolution_clock::now();
+
+		for (index_t i = 0; i < NumInputs; ++i)
+			sum += func(i);
+
+		auto endTime = std::chrono::high_resolution_clock::now();
+		sink = sink + sum;
+		bestNS = std::min(bestNS, std::chrono::duration<double, std::chrono::nanoseconds::period>(endTime - startTime).count() / NumInputs);
+	}
+
+	return bestNS;
+}
+
+// Same test as SeidelTriangulator::WhichSegmentSide(), which is private to the engine.
+template <class _ST>
+static double MeasureWhichSegmentSide(const TypedInputs<_ST>& in)
+{
+	return MeasureNS([&in](index_t i) { return (math3d::point_to_line_sgn_dist_2d(in.c[i], in.lineAB[i]) > _ST(0)) ? 1 : 0; });
+}
+
+template <class _ST>
+static double MeasureOrientation(const TypedInputs<_ST>& in)
+{
+	return MeasureNS([&in](index_t i) { return static_cast<int>(math3d::orientation_2d(in.a[i], in.b[i], in.c[i])); });
+}
+
+template <class _ST>
+static double MeasureSegmentsIntersect(const TypedInputs<_ST>& in)
+{
+	return MeasureNS([&in](index_t i) { return math3d::do_line_segments_intersect_2d(in.a[i], in.b[i], in.c[i], in.d[i]) ? 1 : 0; });
+}
+
+template <class _ST>
+static double MeasureSegmentsIntersectExcludeEndpoints(const TypedInputs<_ST>& in)
+{
+	return MeasureNS([&in](index_t i) { return math3d::do_line_segments_intersect_exclude_endpoints_2d(in.a[i], in.b[i], in.c[i], in.d[i]) ? 1 : 0; });
+}
+
+template <class _ST>
+static double MeasureIntersectLines(const TypedInputs<_ST>& in)
+{
+	return MeasureNS([&in](index_t i) {
+		math3d::vec2<_ST> result;
+		return math3d::intersect_lines_2d(result, in.lineAB[i], in.lineCD[i]) ? ((result.x > _ST(0)) ? 2 : 1) : 0;
+	});
+}
+
+static void MeasureInputSet(const InputSet& set, std::vector<Result>& results)
+{
+	TypedInputs<float> floatInputs;
+	TypedInputs<double> doubleInputs;
+	ConvertInputs(set, floatInputs);
+	ConvertInputs(set, doubleInputs);
+
+	results.push_back({ "which_segment_side", set.name, MeasureWhichSegmentSide(floatInputs), MeasureWhichSegmentSide(doubleInputs) });
+	results.push_back({ "orientation_2d", set.name, MeasureOrientation(floatInputs), MeasureOrientation(doubleInputs) });
+	results.push_back({ "do_line_segments_intersect_2d", set.name, MeasureSegmentsIntersect(floatInputs), MeasureSegmentsIntersect(doubleInputs) });
+	results.push_back({ "do_line_segments_intersect_exclude_endpoints_2d", set.name,
+		MeasureSegmentsIntersectExcludeEndpoints(floatInputs), MeasureSegmentsIntersectExcludeEndpoints(doubleInputs) });
+	results.push_back({ "intersect_lines_2d", set.name, MeasureIntersectLines(floatInputs), MeasureIntersectLines(doubleInputs) });
+}
+
+static bool SaveCSV(const std::string& fileName, const std::vector<Result>& results)
+{
+	std::ofstream file(fileName);
+	if (!file.is_open())
+		return false;
+
+	file.precision(6);
+	file << "predicate,inputs,float_ns,double_ns\n";
+	for (const auto& result : results)
+		file << result.predicate << "," << result.inputSet << "," << result.floatNS << "," << result.doubleNS << "\n";
+
+	return file.good();
+}
+
+int main(int argc, char** argv)
+{
+	std::string polyFile;
+	std::string csvFileName;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::string(argv[i]) == "-csv" && i + 1 < argc)
+			csvFileName = argv[++i];
+		else if (argv[i][0] != '-' && polyFile.empty())
+			polyFile = argv[i];
+		else
+		{
+			std::cout << "Usage: GeometryBenchmark [<polygon file>] [-csv <file>]\n";
+			return -1;
+		}
+	}
+
+	std::mt19937 rndEng(1);
+	std::vector<InputSet> inputSets;
+	inputSets.push_back(MakeUniformSet(rndEng));
+	inputSets.push_back(MakeOffsetSet(rndEng));
+	inputSets.push_back(MakeNearColinearSet(rndEng));
+
+	if (!polyFile.empty())
+	{
+		InputSet polygonSet;
+		if (!MakePolygonSet(polyFile, rndEng, polygonSet))
+		{
+			std::cout << "Error: Failed to load " << polyFile << "\n";
+			return -1;
+		}
+		inputSets.push_back(std::move(polygonSet));
+	}
+
+	std::vector<Result> results;
+	for (const auto& set : inputSets)
+		MeasureInputSet(set, results);
+
+	std::cout << std::left << std::setw(50) << "Predicate" << std::setw(16) << "Inputs" << std::right
+		<< std::setw(12) << "float ns" << std::setw(12) << "double ns" << "\n";
+
+	for (const auto& result : results)
+	{
+		std::cout << std::left << std::setw(50) << result.predicate << std::setw(16) << result.inputSet << std::right
+			<< std::setw(12) << result.floatNS << std::setw(12) << result.doubleNS << "\n";
+	}
+
+	if (!csvFileName.empty() && !SaveCSV(csvFileName, results))
+	{
+		std::cout << "Error: Failed to write " << csvFileName << "\n";
+		return -1;
+	}
+
+	return 0;
+}
@@ -2,9 +2,19 @@
 #include <iostream>
 #include <string>
 #include <cstring>
+#include <chrono>
+#include <iomanip>
+#include <cmath>
+#include <filesystem>
 #include <GLFW/glfw3.h>
 #include "MainWindow.h"
 #include "Benchmark.h"
+#include "BatchTriangulator.h"
+#include "Serialization.h"
+#include "Generators.h"
+#include "MeshWriter.h"
+#include "GeoImport.h"
+#include "BatchRunner.h"
 
 
 int RunGUI()
@@ -32,34 +42,956 @@ int RunGUI()
 	return 0;
 }
 
-void DoBenchmark(const char* polygonFileName, int numIter)
+// Optional command line parameters that follow the required ones.
+struct Options
 {
-	Benchmark bmark;
+	TriangulatorType type = TriangulatorType::Seidel;
+	std::string jsonFileName;
+	std::string csvFileName;
+	std::uint32_t seed = 1;
+	Benchmark::SegmentOrder segmentOrder = Benchmark::SegmentOrder::Reshuffle;
+	bool collectCounters = false;
+	bool trackAllocations = false;
+	bool dropCache = false;
+	bool binaryOutput = false;
+	double scale = 1.0;
+	bool center = false;
+	double gridSize = 0.0;
+	bool hasRect = false;	// Load only the outlines that intersect the rectangle.
+	math3d::vec2f rectMin;
+	math3d::vec2f rectMax;
+	int_t numThreads = 0;
+	int_t memoryBudgetMB = 1024;
+	int_t cacheMB = BatchTriangulator::DefaultMaxCacheBytes >> 20;
+	BatchRunner::OutputFormat outputFormat = BatchRunner::OutputFormat::Text;
+	double frameBudgetMS = -1.0;	// Run the Seidel engine in resumable steps of this length.
+	std::string traceFileName;
+	bool traceDetails = false;
+};
+
+bool ParseOptions(int argc, char** argv, int firstArg, Options& options)
+{
+	for (int i = firstArg; i < argc; i += 2)
+	{
+		std::string name = argv[i];
+		if (i + 1 >= argc)
+		{
+			std::cout << "Missing value of the \"" << name << "\" parameter.\n";
+			return false;
+		}
+
+		std::string value = argv[i + 1];
+
+		if (name == "-e")
+		{
+			if (!ParseTriangulatorType(value, options.type))
+			{
+				std::cout << "Wrong \"engine\" parameter.\n";
+				return false;
+			}
+		}
+		else if (name == "-json")
+		{
+			options.jsonFileName = value;
+		}
+		else if (name == "-csv")
+		{
+			options.csvFileName = value;
+		}
+		else if (name == "-seed")
+		{
+			try
+			{
+				options.seed = static_cast<std::uint32_t>(std::stoul(value));
+			}
+			catch (const std::exception&)
+			{
+				std::cout << "Wrong \"seed\" parameter.\n";
+				return false;
+			}
+		}
+		else if (name == "-order")
+		{
+			if (!Benchmark::ParseSegmentOrder(value, options.segmentOrder))
+			{
+				std::cout << "Wrong \"order\" parameter.\n";
+				return false;
+			}
+		}
+		else if (name == "-counters")
+		{
+			if (value != "on" && value != "off")
+			{
+				std::cout << "Wrong \"counters\" parameter.\n";
+				return false;
+			}
+
+			options.collectCounters = (value == "on");
+		}
+		else if (name == "-allocations")
+		{
+			if (value != "on" && value != "off")
+			{
+				std::cout << "Wrong \"allocations\" parameter.\n";
+				return false;
+			}
+
+			options.trackAllocations = (value == "on");
+		}
+		else if (name == "-trace")
+		{
+			options.traceFileName = value;
+		}
+		else if (name == "-tracedetails")
+		{
+			if (value != "on" && value != "off")
+			{
+				std::cout << "Wrong \"tracedetails\" parameter.\n";
+				return false;
+			}
+
+			options.traceDetails = (value == "on");
+		}
+		else if (name == "-dropcache")
+		{
+			if (value != "on" && value != "off")
+			{
+				std::cout << "Wrong \"dropcache\" parameter.\n";
+				return false;
+			}
+
+			options.dropCache = (value == "on");
+		}
+		else if (name == "-binary")
+		{
+			if (value != "on" && value != "off")
+			{
+				std::cout << "Wrong \"binary\" parameter.\n";
+				return false;
+			}
+
+			options.binaryOutput = (value == "on");
+		}
+		else if (name == "-scale")
+		{
+			try
+			{
+				options.scale = std::stod(value);
+			}
+			catch (const std::exception&)
+			{
+				std::cout << "Wrong \"scale\" parameter.\n";
+				return false;
+			}
+		}
+		else if (name == "-center")
+		{
+			if (value != "on" && value != "off")
+			{
+				std::cout << "Wrong \"center\" parameter.\n";
+				return false;
+			}
+
+			options.center = (value == "on");
+		}
+		else if (name == "-rect")
+		{
+			auto values = SplitString(value, ',');
+			bool valid = (values.size() == 4);
+			try
+			{
+				if (valid)
+				{
+					options.rectMin = { std::stof(values[0]), std::stof(values[1]) };
+					options.rectMax = { std::stof(values[2]), std::stof(values[3]) };
+				}
+			}
+			catch (const std::exception&)
+			{
+				valid = false;
+			}
+
+			if (!valid)
+			{
+				std::cout << "Wrong \"rect\" parameter.\n";
+				return false;
+			}
+
+			options.hasRect = true;
+		}
+		else if (name == "-threads" || name == "-memory" || name == "-cache")
+		{
+			int_t number = 0;
+			try
+			{
+				number = std::stoll(value);
+			}
+			catch (const std::exception&)
+			{
+				number = 0;
+			}
+
+			if (number <= 0)
+			{
+				std::cout << "Wrong \"" << name.substr(1) << "\" parameter.\n";
+				return false;
+			}
+
+			if (name == "-threads")
+				options.numThreads = number;
+			else if (name == "-memory")
+				options.memoryBudgetMB = number;
+			else
+				options.cacheMB = number;
+		}
+		else if (name == "-format")
+		{
+			if (!BatchRunner::ParseOutputFormat(value, options.outputFormat))
+			{
+				std::cout << "Wrong \"format\" parameter.\n";
+				return false;
+			}
+		}
+		else if (name == "-frame")
+		{
+			double budget = 0.0;
+			try
+			{
+				budget = std::stod(value);
+			}
+			catch (const std::exception&)
+			{
+				budget = 0.0;
+			}
+
+			if (budget <= 0.0)
+			{
+				std::cout << "Wrong \"frame\" parameter.\n";
+				return false;
+			}
+
+			options.frameBudgetMS = budget;
+		}
+		else if (name == "-grid")
+		{
+			try
+			{
+				options.gridSize = std::stod(value);
+			}
+			catch (const std::exception&)
+			{
+				std::cout << "Wrong \"grid\" parameter.\n";
+				return false;
+			}
+		}
+		else
+		{
+			std::cout << "Unknown parameter \"" << name << "\".\n";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void PrintPhaseStatistics(const Benchmark::Statistics& stats)
+{
+	auto printRow = [](const char* name, const Benchmark::PhaseStatistics& phase) {
+		std::cout << std::left << std::setw(24) << name << std::right
+			<< std::setw(12) << phase.minMS
+			<< std::setw(12) << phase.medianMS
+			<< std::setw(12) << phase.p90MS
+			<< std::setw(12) << phase.p99MS
+			<< std::setw(12) << phase.maxMS << "\n";
+	};
+
+	std::cout << std::left << std::setw(24) << "Phase (ms)" << std::right
+		<< std::setw(12) << "min"
+		<< std::setw(12) << "median"
+		<< std::setw(12) << "p90"
+		<< std::setw(12) << "p99"
+		<< std::setw(12) << "max" << "\n";
+
+	for (index_t p = 0; p < Benchmark::NumPhases; ++p)
+	{
+		if (stats.phases[p].measured)
+			printRow(Triangulator::GetPhaseName(static_cast<Triangulator::Phase>(p)), stats.phases[p]);
+	}
+
+	printRow("total", stats.iteration);
+	std::cout << "Standard deviation: " << stats.iteration.stdDevMS << " ms\n";
+}
+
+void PrintTreeStatistics(const Benchmark::Statistics& stats)
+{
+	if (!stats.tree.measured)
+		return;
+
+	auto printRow = [](const char* name, const Benchmark::ValueStatistics& value) {
+		std::cout << std::left << std::setw(24) << name << std::right
+			<< std::setw(12) << value.min
+			<< std::setw(12) << value.median
+			<< std::setw(12) << value.max
+			<< std::setw(12) << value.mean
+			<< std::setw(12) << value.stdDev << "\n";
+	};
+
+	std::cout << std::left << std::setw(24) << "History DAG" << std::right
+		<< std::setw(12) << "min"
+		<< std::setw(12) << "median"
+		<< std::setw(12) << "max"
+		<< std::setw(12) << "mean"
+		<< std::setw(12) << "std dev" << "\n";
+
+	printRow("max depth", stats.tree.maxDepth);
+	printRow("average depth", stats.tree.averageDepth);
+	printRow("nodes", stats.tree.numNodes);
+	printRow("bytes", stats.tree.numBytes);
+	std::cout << "Trapezoid map: " << stats.tree.numBytes.median / std::max<int_t>(stats.numPoints, 1) << " bytes per vertex\n";
+}
+
+void PrintEngineStatistics(const Benchmark::Statistics& stats)
+{
+	if (!stats.engineMeasured)
+		return;
+
+	const auto& engine = stats.engine;
+	double numIter = static_cast<double>(std::max<int_t>(stats.numIterations, 1));
+	double numLocations = static_cast<double>(std::max<int_t>(engine.numPointLocations, 1));
+
+	std::cout << "Operations per iteration:\n"
+		<< "  point locations: " << engine.numPointLocations / numIter
+		<< ", " << engine.numNodesVisited / numLocations << " nodes on average, " << engine.maxLocationDepth << " at most\n"
+		<< "  trapezoid splits: " << engine.numTrapezoidSplits / numIter << "\n"
+		<< "  merges: " << engine.numMerges / numIter << "\n"
+		<< "  predicates: " << engine.numPredicates / numIter << "\n"
+		<< "  monotone chains: " << engine.numMonotoneChains / numIter << "\n";
+
+	std::cout << "Chain lengths:\n";
+	for (index_t b = 0; b < SeidelTriangulator::Statistics::NumChainLengthBuckets; ++b)
+	{
+		if (engine.chainLengthHistogram[b] > 0)
+			std::cout << "  " << (index_t(1) << b) << "-" << (index_t(2) << b) - 1 << ": " << engine.chainLengthHistogram[b] / numIter << "\n";
+	}
+}
+
+void PrintCounterStatistics(const Benchmark::Statistics& stats)
+{
+	if (!stats.countersMeasured)
+	{
+		std::cout << "Hardware counters are not available.\n";
+		return;
+	}
+
+	auto printRow = [&stats](const char* name, const Benchmark::PhaseStatistics& phase) {
+		std::cout << std::left << std::setw(24) << name << std::right;
+		for (index_t c = 0; c < PerfCounters::NumCounters; ++c)
+		{
+			if (stats.counterAvailable[c])
+				std::cout << std::setw(16) << phase.counts[c] / std::max<int_t>(stats.numPoints, 1);
+		}
+		std::cout << "\n";
+	};
+
+	std::cout << std::left << std::setw(24) << "Counts per vertex" << std::right;
+	for (index_t c = 0; c < PerfCounters::NumCounters; ++c)
+	{
+		if (stats.counterAvailable[c])
+			std::cout << std::setw(16) << PerfCounters::GetCounterName(static_cast<PerfCounters::Counter>(c));
+	}
+	std::cout << "\n";
+
+	for (index_t p = 0; p < Benchmark::NumPhases; ++p)
+	{
+		if (stats.phases[p].measured)
+			printRow(Triangulator::GetPhaseName(static_cast<Triangulator::Phase>(p)), stats.phases[p]);
+	}
+
+	printRow("total", stats.iteration);
+}
+
+void PrintAllocationStatistics(const Benchmark::Statistics& stats)
+{
+	if (!stats.allocationsMeasured)
+	{
+		std::cout << "Allocation tracking is not compiled in, build with TRACK_ALLOCATIONS.\n";
+		return;
+	}
+
+	auto printRow = [&stats](const char* name, const Benchmark::PhaseStatistics& phase) {
+		std::cout << std::left << std::setw(24) << name << std::right
+			<< std::setw(16) << phase.numAllocations
+			<< std::setw(16) << phase.allocatedBytes
+			<< std::setw(16) << phase.peakLiveBytes
+			<< std::setw(16) << phase.allocatedBytes / std::max<int_t>(stats.numPoints, 1) << "\n";
+	};
+
+	std::cout << std::left << std::setw(24) << "Heap" << std::right
+		<< std::setw(16) << "allocations"
+		<< std::setw(16) << "bytes"
+		<< std::setw(16) << "peak live"
+		<< std::setw(16) << "bytes/vertex" << "\n";
+
+	for (index_t p = 0; p < Benchmark::NumPhases; ++p)
+	{
+		if (stats.phases[p].measured)
+			printRow(Triangulator::GetPhaseName(static_cast<Triangulator::Phase>(p)), stats.phases[p]);
+	}
+
+	printRow("total", stats.iteration);
+}
+
+void DoBenchmark(const char* polygonPath, int numIter, const Options& options)
+{
+	std::vector<std::string> polygonFiles;
+	if (!ListPolyFiles(polygonPath, polygonFiles))
+	{
+		std::cout << "Error: Failed to find polygon files.\n";
+		return;
+	}
+
+	std::vector<Benchmark::Statistics> allStats;
+	TraceRecorder traceRecorder(0, options.traceDetails);
+	std::cout << "Engine: " << GetTriangulatorName(options.type) << "\n";
+	if (options.type == TriangulatorType::Seidel)
+		std::cout << "Segment order: " << Benchmark::GetSegmentOrderName(options.segmentOrder) << ", seed " << options.seed << "\n";
+
+	for (const auto& polygonFile : polygonFiles)
+	{
+		Benchmark bmark;
+		std::string errDesc;
+
+		std::cout << "\nFile: " << polygonFile << "\n";
+
+		if (bmark.LoadPolygon(polygonFile.c_str(), options.type, errDesc))
+		{
+			Benchmark::Statistics stats;
+			bmark.SetSegmentOrder(options.segmentOrder, options.seed);
+			bmark.SetCollectCounters(options.collectCounters);
+			bmark.SetTrackAllocations(options.trackAllocations);
+			bmark.SetFrameBudget(options.frameBudgetMS);
+			if (!options.traceFileName.empty())
+				bmark.SetTraceRecorder(&traceRecorder);
+			bmark.Run(numIter, stats);
+			std::cout
+				<< "Finished in " << stats.totalTimeMS << " ms\n"
+				<< "Number of outlines: " << stats.numOutlines << "\n"
+				<< "Total number of points: " << stats.numPoints << "\n"
+				<< "Number of triangles: " << stats.numTriangles << "\n"
+				<< "Triangle output: " << static_cast<double>(stats.outputBytes) / std::max<int_t>(stats.numPoints, 1) << " bytes per vertex\n"
+				<< "Average algorithm time: " << stats.averageTimeMS << " ms\n";
+			if (stats.framesMeasured)
+				std::cout << "Frames per iteration: " << stats.numFrames.median << ", frame time median " << stats.frames.medianMS
+					<< " ms, p99 " << stats.frames.p99MS << " ms, max " << stats.frames.maxMS << " ms\n";
+			PrintPhaseStatistics(stats);
+			PrintTreeStatistics(stats);
+			PrintEngineStatistics(stats);
+			if (options.collectCounters)
+				PrintCounterStatistics(stats);
+			if (options.trackAllocations)
+				PrintAllocationStatistics(stats);
+			allStats.push_back(std::move(stats));
+		}
+		else
+		{
+			std::cout << "Error: " << errDesc << "\n";
+		}
+	}
+
+	if (!options.jsonFileName.empty() && !Benchmark::SaveJSON(options.jsonFileName, allStats))
+		std::cout << "Error: Failed to write " << options.jsonFileName << "\n";
+
+	if (!options.csvFileName.empty() && !Benchmark::SaveCSV(options.csvFileName, allStats))
+		std::cout << "Error: Failed to write " << options.csvFileName << "\n";
+
+	if (!options.traceFileName.empty() && !TraceRecorder::SaveJSON(options.traceFileName, { &traceRecorder }))
+		std::cout << "Error: Failed to write " << options.traceFileName << "\n";
+}
+
+void DoBatch(const char* polygonDirName, const Options& options)
+{
+	std::vector<std::string> polygonFiles;
+	if (!ListPolyFiles(polygonDirName, polygonFiles))
+	{
+		std::cout << "Error: Failed to read polygon directory.\n";
+		return;
+	}
+
+	BatchTriangulator batch(options.type, Triangulator::FillRule::EvenOdd, Triangulator::Winding::CW, options.cacheMB << 20);
+	OutlineList outlines;
+	IndexList triangleIndices;
+	int_t numTriangles = 0;
+	double timeMS = 0.0;
+
+	for (const auto& polygonFile : polygonFiles)
+	{
+		outlines.clear();
+		if (!LoadPolyFile(polygonFile, outlines))
+		{
+			std::cout << "Error: Failed to load " << polygonFile << "\n";
+			continue;
+		}
+
+		auto startTime = std::chrono::high_resolution_clock::now();
+		batch.Triangulate(outlines, triangleIndices);
+		auto endTime = std::chrono::high_resolution_clock::now();
+
+		timeMS += std::chrono::duration<double, std::chrono::milliseconds::period>(endTime - startTime).count();
+		numTriangles += triangleIndices.size() / 3;
+	}
+
+	const auto& stats = batch.GetStatistics();
+	std::cout
+		<< "Engine: " << GetTriangulatorName(options.type) << "\n"
+		<< "Finished in " << timeMS << " ms\n"
+		<< "Number of polygons: " << stats.numPolygons << "\n"
+		<< "Unique shapes: " << stats.numUniqueShapes << "\n"
+		<< "Cache hits: " << stats.numCacheHits << "\n"
+		<< "Hit rate: " << stats.HitRate() * 100.0 << " %\n"
+		<< "Evicted shapes: " << stats.numEvictedShapes << "\n"
+		<< "Cache size (bytes): " << batch.GetCacheBytes() << "\n"
+		<< "Not simple: " << stats.numFailed << "\n"
+		<< "Number of triangles: " << numTriangles << "\n";
+}
+
+// Time loading, triangulation and saving of each polygon, writing the triangles to the output directory. Returns
+// the exit code: 0 if every file succeeded, 1 if any failed or an output was not written and 2 if there was nothing to do.
+int DoEndToEnd(const char* polygonPath, int numIter, const char* outputDirName, const Options& options)
+{
+	std::vector<std::string> polygonFiles;
+	if (!ListPolyFiles(polygonPath, polygonFiles))
+	{
+		std::cout << "Error: Failed to find polygon files.\n";
+		return 2;
+	}
+
+	int exitCode = 0;
+
+	std::vector<Benchmark::EndToEndStatistics> allStats;
+	std::cout << "Engine: " << GetTriangulatorName(options.type) << "\n";
+
+	for (const auto& polygonFile : polygonFiles)
+	{
+		std::string outputPrefix = (std::filesystem::path(outputDirName) / std::filesystem::path(polygonFile).stem()).string();
+		Benchmark::EndToEndStatistics stats;
+		std::string errDesc;
+
+		std::cout << "\nFile: " << polygonFile << "\n";
+
+		if (!Benchmark::RunEndToEnd(polygonFile, outputPrefix, options.type, numIter, options.dropCache, options.binaryOutput, stats, errDesc))
+		{
+			std::cout << "Error: " << errDesc << "\n";
+			exitCode = 1;
+			continue;
+		}
+
+		// The times are still shown, but the cold load asked for was not measured.
+		if (options.dropCache && !stats.cacheDropped)
+		{
+			std::cout << "Error: Could not drop the page cache, loads are warm.\n";
+			exitCode = 1;
+		}
+
+		std::cout << "Total number of points: " << stats.numPoints << "\n"
+			<< "Number of triangles: " << stats.numTriangles << "\n"
+			<< std::left << std::setw(24) << "Stage (ms)" << std::right
+			<< std::setw(12) << "min" << std::setw(12) << "median" << std::setw(12) << "max" << std::setw(12) << "share %" << "\n";
+
+		for (index_t st = 0; st <= Benchmark::NumStages; ++st)
+		{
+			bool isTotal = (st == Benchmark::NumStages);
+			const auto& stage = isTotal ? stats.total : stats.stages[st];
+			double share = (stats.total.meanMS > 0.0) ? 100.0 * stage.meanMS / stats.total.meanMS : 0.0;
+
+			std::cout << std::left << std::setw(24) << (isTotal ? "total" : Benchmark::GetStageName(static_cast<Benchmark::Stage>(st))) << std::right
+				<< std::setw(12) << stage.minMS << std::setw(12) << stage.medianMS << std::setw(12) << stage.maxMS << std::setw(12) << share << "\n";
+		}
+
+		allStats.push_back(std::move(stats));
+	}
+
+	if (!options.jsonFileName.empty() && !Benchmark::SaveJSON(options.jsonFileName, allStats))
+	{
+		std::cout << "Error: Failed to write " << options.jsonFileName << "\n";
+		exitCode = 1;
+	}
+
+	if (!options.csvFileName.empty() && !Benchmark::SaveCSV(options.csvFileName, allStats))
+	{
+		std::cout << "Error: Failed to write " << options.csvFileName << "\n";
+		exitCode = 1;
+	}
+
+	return exitCode;
+}
+
+// Triangulate the corpus on 1 to maxThreads threads, each thread with its own copy of it. Returns the exit code:
+// 0 if every step succeeded, 1 if a file could not be used or an output not written and 2 if there was nothing to do.
+int DoThroughput(const char* polygonPath, int_t maxThreads, const Options& options)
+{
+	std::vector<std::string> polygonFiles;
+	if (!ListPolyFiles(polygonPath, polygonFiles))
+	{
+		std::cout << "Error: Failed to find polygon files.\n";
+		return 2;
+	}
+
+	int exitCode = 0;
+
+	std::vector<OutlineList> corpus;
+	for (const auto& polygonFile : polygonFiles)
+	{
+		OutlineList outlines;
+		if (!LoadPolyFile(polygonFile, outlines))
+		{
+			std::cout << "Error: Failed to load " << polygonFile << "\n";
+			exitCode = 1;
+		}
+		else if (!CreateTriangulator(options.type, outlines)->IsSimplePolygon())
+		{
+			std::cout << "Error: " << polygonFile << " is not a simple polygon.\n";
+			exitCode = 1;
+		}
+		else
+		{
+			corpus.push_back(std::move(outlines));
+		}
+	}
+
+	if (corpus.empty())
+	{
+		std::cout << "Error: No polygon to triangulate.\n";
+		return 2;
+	}
+
+	// Enough rounds for the single thread run to take about a second.
+	Benchmark::ThroughputStatistics probe;
+	Benchmark::RunThroughput(corpus, options.type, 1, 1, probe);
+	int_t numRounds = std::max<int_t>(1, static_cast<int_t>(std::ceil(1000.0 / std::max(probe.timeMS, 1e-3))));
+
+	std::vector<Benchmark::ThroughputStatistics> allStats;
+	std::cout << "Engine: " << GetTriangulatorName(options.type) << "\n"
+		<< "Polygons in corpus: " << corpus.size() << "\n"
+		<< "Rounds per thread: " << numRounds << "\n"
+		<< std::setw(8) << "Threads" << std::setw(16) << "Polygons/s" << std::setw(16) << "Vertices/s" << std::setw(16) << "Efficiency" << "\n";
+
+	// Only the run with the most threads is traced.
+	std::vector<TraceRecorder> traceRecorders;
+	if (!options.traceFileName.empty())
+	{
+		for (index_t t = 0; t < maxThreads; ++t)
+			traceRecorders.emplace_back(t, options.traceDetails);
+	}
+
+	for (int_t numThreads = 1; numThreads <= maxThreads; ++numThreads)
+	{
+		Benchmark::ThroughputStatistics stats;
+		bool trace = !traceRecorders.empty() && numThreads == maxThreads;
+		Benchmark::RunThroughput(corpus, options.type, numThreads, numRounds, stats, trace ? &traceRecorders : nullptr);
+
+		if (!allStats.empty() && allStats.front().polygonsPerSecond > 0.0)
+			stats.efficiency = stats.polygonsPerSecond / (numThreads * allStats.front().polygonsPerSecond);
+		else
+			stats.efficiency = 1.0;
+
+		std::cout << std::setw(8) << numThreads << std::setw(16) << stats.polygonsPerSecond
+			<< std::setw(16) << stats.verticesPerSecond << std::setw(16) << stats.efficiency << "\n";
+
+		allStats.push_back(stats);
+	}
+
+	if (!options.jsonFileName.empty() && !Benchmark::SaveJSON(options.jsonFileName, allStats))
+	{
+		std::cout << "Error: Failed to write " << options.jsonFileName << "\n";
+		exitCode = 1;
+	}
+
+	if (!options.csvFileName.empty() && !Benchmark::SaveCSV(options.csvFileName, allStats))
+	{
+		std::cout << "Error: Failed to write " << options.csvFileName << "\n";
+		exitCode = 1;
+	}
+
+	if (!traceRecorders.empty())
+	{
+		std::vector<const TraceRecorder*> recorders;
+		for (const auto& recorder : traceRecorders)
+			recorders.push_back(&recorder);
+
+		if (!TraceRecorder::SaveJSON(options.traceFileName, recorders))
+		{
+			std::cout << "Error: Failed to write " << options.traceFileName << "\n";
+			exitCode = 1;
+		}
+	}
+
+	return exitCode;
+}
+
+// Generate a polygon and save it. Returns the exit code.
+int DoGenerate(GeneratorType genType, int_t numVertices, const char* polygonFileName, const Options& options)
+{
+	OutlineList outlines;
+	GeneratePolygon(genType, numVertices, options.seed, outlines);
+
+	int_t numPoints = 0;
+	for (const auto& outl : outlines)
+		numPoints += outl.size();
+
+	if (!SavePolyFile(polygonFileName, outlines, options.gridSize))
+	{
+		std::cout << "Error: Failed to write " << polygonFileName << "\n";
+		return 1;
+	}
+
+	std::cout
+		<< "Generator: " << GetGeneratorName(genType) << "\n"
+		<< "Number of outlines: " << outlines.size() << "\n"
+		<< "Total number of points: " << numPoints << "\n";
+
+	return 0;
+}
+
+// Triangulate the polygon straight into a mesh file, without keeping the triangle list. Returns the exit code.
+int DoExportMesh(const char* polygonFileName, const char* meshFileName, const Options& options)
+{
+	MeshFormat format;
+	if (!GetMeshFormatOfFile(meshFileName, format))
+	{
+		std::cout << "Error: Unknown mesh format, use the .obj, .ply or .stl extension.\n";
+		return 1;
+	}
+
+	OutlineList outlines;
+	bool loaded = options.hasRect ?
+		LoadPolyFile(polygonFileName, options.rectMin, options.rectMax, outlines) :
+		LoadPolyFile(polygonFileName, outlines);
+	if (!loaded)
+	{
+		std::cout << "Error: Failed to load " << polygonFileName << "\n";
+		return 1;
+	}
+
+	// Checked before opening, so that no file is left behind for a polygon that can't be triangulated.
+	auto triangulator = CreateTriangulator(options.type, outlines);
+	if (!triangulator->IsSimplePolygon())
+	{
+		std::cout << "Error: Not a simple polygon.\n";
+		return 1;
+	}
+
+	MeshWriter writer;
+	if (!writer.Open(meshFileName, format, triangulator->GetPointCoords()))
+	{
+		std::cout << "Error: Failed to write " << meshFileName << "\n";
+		return 1;
+	}
+
+	// Counter-clockwise, so that the faces point up.
+	triangulator->Triangulate(Triangulator::FillRule::EvenOdd, Triangulator::Winding::CCW, writer);
+	if (!writer.Close())
+	{
+		std::cout << "Error: Failed to write " << meshFileName << "\n";
+		return 1;
+	}
+
+	std::cout
+		<< "Format: " << GetMeshFormatName(format) << "\n"
+		<< "Number of points: " << triangulator->GetPointCoords().size() << "\n"
+		<< "Number of triangles: " << writer.GetNumTriangles() << "\n";
+
+	return 0;
+}
+
+// Triangulate all files on a worker pool and write the results. Returns the exit code: 0 if every file succeeded,
+// 1 if any failed and 2 if there was nothing to do.
+int DoParallelBatch(const char* inputPath, const char* outputDirName, const Options& options)
+{
+	std::vector<std::string> polygonFiles;
+	if (!BatchRunner::ListInputFiles(inputPath, polygonFiles) || polygonFiles.empty())
+	{
+		std::cout << "Error: Failed to find polygon files.\n";
+		return 2;
+	}
+
+	std::error_code ec;
+	std::filesystem::create_directories(outputDirName, ec);
+	if (!std::filesystem::is_directory(outputDirName, ec))
+	{
+		std::cout << "Error: Failed to create " << outputDirName << "\n";
+		return 2;
+	}
+
+	BatchRunner::Options runOptions;
+	runOptions.type = options.type;
+	runOptions.format = options.outputFormat;
+	runOptions.outputDirectory = outputDirName;
+	runOptions.numThreads = options.numThreads;
+	runOptions.memoryBudget = options.memoryBudgetMB << 20;
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+	std::vector<BatchRunner::FileResult> results;
+	BatchRunner::Run(polygonFiles, runOptions, results);
+	auto endTime = std::chrono::high_resolution_clock::now();
+
+	int_t numFailed = 0;
+	for (const auto& result : results)
+	{
+		if (!result.success)
+		{
+			std::cerr << "Error: " << result.fileName << ": " << result.errDesc << "\n";
+			++numFailed;
+		}
+	}
+
+	std::cout
+		<< "Engine: " << GetTriangulatorName(options.type) << "\n"
+		<< "Output format: " << BatchRunner::GetOutputFormatName(options.outputFormat) << "\n"
+		<< "Files: " << results.size() << ", succeeded: " << results.size() - numFailed << ", failed: " << numFailed << "\n"
+		<< "Time (ms): " << std::chrono::duration<double, std::chrono::milliseconds::period>(endTime - startTime).count() << "\n";
+
+	if (!options.jsonFileName.empty() && !BatchRunner::SaveJSON(options.jsonFileName, results))
+		std::cout << "Error: Failed to write " << options.jsonFileName << "\n";
+
+	if (!options.csvFileName.empty() && !BatchRunner::SaveCSV(options.csvFileName, results))
+		std::cout << "Error: Failed to write " << options.csvFileName << "\n";
+
+	return (numFailed > 0) ? 1 : 0;
+}
+
+// Convert polygons from a GIS file into a polygon file. Returns the exit code.
+int DoImport(const char* geoFileName, const char* polygonFileName, const Options& options)
+{
+	GeoFormat format;
+	if (!GetGeoFormatOfFile(geoFileName, format))
+	{
+		std::cout << "Error: Unknown GIS format, use the .geojson, .json, .wkt or .wkb extension.\n";
+		return 1;
+	}
+
+	GeoImportOptions importOptions;
+	importOptions.scale = options.scale;
+	importOptions.center = options.center;
+
+	OutlineList outlines;
 	std::string errDesc;
-	if (bmark.LoadPolygon(polygonFileName, errDesc))
+	if (!ImportGeoFile(geoFileName, format, importOptions, outlines, errDesc))
 	{
+		std::cout << "Error: " << errDesc << "\n";
+		return 1;
+	}
+
+	int_t numPoints = 0;
+	for (const auto& outl : outlines)
+		numPoints += outl.size();
+
+	if (!SavePolyFile(polygonFileName, outlines, options.gridSize))
+	{
+		std::cout << "Error: Failed to write " << polygonFileName << "\n";
+		return 1;
+	}
+
+	std::cout
+		<< "Format: " << GetGeoFormatName(format) << "\n"
+		<< "Number of outlines: " << outlines.size() << "\n"
+		<< "Total number of points: " << numPoints << "\n";
+
+	return 0;
+}
+
+// Triangulate generated polygons of doubling size and fit the time as a function of the vertex count.
+void DoScaling(GeneratorType genType, int_t maxVertices, const Options& options)
+{
+	const int numIter = 3;
+	std::vector<Benchmark::Statistics> allStats;
+	std::vector<double> vertexCounts;
+	std::vector<double> times;
+
+	std::cout << "Engine: " << GetTriangulatorName(options.type) << "\n"
+		<< "Generator: " << GetGeneratorName(genType) << "\n"
+		<< "The fit uses the median times of construction and triangulation, without the validation of the polygon.\n"
+		<< std::setw(12) << "Vertices" << std::setw(16) << "Validation ms" << std::setw(16) << "Median ms" << std::setw(16) << "ns/vertex" << "\n";
+
+	for (int_t n = 1024; n <= maxVertices; n *= 2)
+	{
+		OutlineList outlines;
+		GeneratePolygon(genType, n, options.seed, outlines);
+
+		Benchmark bmark;
+		std::string errDesc;
+		std::string name = std::string(GetGeneratorName(genType)) + "-" + std::to_string(n);
+
+		if (!bmark.SetPolygon(std::move(outlines), name, options.type, errDesc))
+		{
+			std::cout << "Error: " << name << ": " << errDesc << "\n";
+			continue;
+		}
+
 		Benchmark::Statistics stats;
+		bmark.SetSegmentOrder(options.segmentOrder, options.seed);
 		bmark.Run(numIter, stats);
-		std::cout
-			<< "Finished in " << stats.totalTimeMS << " ms\n"
-			<< "Number of outlines: " << stats.numOutlines << "\n"
-			<< "Total number of points: " << stats.numPoints << "\n"
-			<< "Average algorithm time: " << stats.averageTimeMS << " ms\n";
+
+		double medianMS = stats.algorithm.medianMS;
+		std::cout << std::setw(12) << stats.numPoints << std::setw(16) << stats.phases[static_cast<index_t>(Triangulator::Phase::Validation)].medianMS << std::setw(16) << medianMS
+			<< std::setw(16) << medianMS * 1e6 / stats.numPoints << "\n";
+
+		vertexCounts.push_back(static_cast<double>(stats.numPoints));
+		times.push_back(medianMS);
+		allStats.push_back(std::move(stats));
 	}
-	else
+
+	// Least squares fits of time = a + b * n and of log(time) = log(c) + k * log(n).
+	if (vertexCounts.size() >= 2)
 	{
-		std::cout << "Error: " << errDesc << "\n";
+		double count = static_cast<double>(vertexCounts.size());
+		double sn = 0.0, st = 0.0, snn = 0.0, snt = 0.0;
+		double sl = 0.0, slt = 0.0, sll = 0.0, sltt = 0.0;
+
+		for (index_t i = 0; i < vertexCounts.size(); ++i)
+		{
+			double n = vertexCounts[i];
+			double t = times[i];
+			sn += n;
+			st += t;
+			snn += n * n;
+			snt += n * t;
+
+			double ln = std::log(n);
+			double lt = std::log(std::max(t, 1e-9));
+			sl += ln;
+			slt += lt;
+			sll += ln * ln;
+			sltt += ln * lt;
+		}
+
+		double slope = (count * snt - sn * st) / (count * snn - sn * sn);
+		double exponent = (count * sltt - sl * slt) / (count * sll - sl * sl);
+
+		std::cout
+			<< "Fitted time per vertex: " << slope * 1e6 << " ns\n"
+			<< "Fitted exponent: " << exponent << "\n";
 	}
+
+	if (!options.jsonFileName.empty() && !Benchmark::SaveJSON(options.jsonFileName, allStats))
+		std::cout << "Error: Failed to write " << options.jsonFileName << "\n";
+
+	if (!options.csvFileName.empty() && !Benchmark::SaveCSV(options.csvFileName, allStats))
+		std::cout << "Error: Failed to write " << options.csvFileName << "\n";
 }
 
 int main(int argc, char** argv)
 {
+	Options options;
+
 	if (argc == 1)
 	{
 		return RunGUI();
 	}
-	else if (argc == 4 && std::strncmp(argv[1], "-b", 3) == 0)
+	else if (argc >= 4 && std::strncmp(argv[1], "-b", 3) == 0)
 	{
+		if (!ParseOptions(argc, argv, 4, options))
+			return -1;
+
 		int iters = 0;
 		try
 		{
@@ -71,14 +1003,148 @@ int main(int argc, char** argv)
 			return -1;
 		}
 
-		DoBenchmark(argv[2], iters);
+		DoBenchmark(argv[2], iters, options);
+	}
+	else if (argc >= 3 && std::strncmp(argv[1], "-d", 3) == 0)
+	{
+		if (!ParseOptions(argc, argv, 3, options))
+			return -1;
+
+		DoBatch(argv[2], options);
+	}
+	else if (argc >= 5 && std::strncmp(argv[1], "-x", 3) == 0)
+	{
+		if (!ParseOptions(argc, argv, 5, options))
+			return -1;
+
+		int iters = 0;
+		try
+		{
+			iters = std::stoi(argv[3]);
+		}
+		catch (const std::exception&)
+		{
+			std::cout << "Wrong \"number of iterations\" parameter.\n";
+			return -1;
+		}
+
+		return DoEndToEnd(argv[2], iters, argv[4], options);
+	}
+	else if (argc >= 4 && std::strncmp(argv[1], "-t", 3) == 0)
+	{
+		if (!ParseOptions(argc, argv, 4, options))
+			return -1;
+
+		int_t maxThreads = 0;
+		try
+		{
+			maxThreads = std::stoll(argv[3]);
+		}
+		catch (const std::exception&)
+		{
+			std::cout << "Wrong \"number of threads\" parameter.\n";
+			return -1;
+		}
+
+		if (maxThreads < 1)
+		{
+			std::cout << "The number of threads must be at least 1.\n";
+			return -1;
+		}
+
+		return DoThroughput(argv[2], maxThreads, options);
+	}
+	else if (argc >= 5 && std::strncmp(argv[1], "-g", 3) == 0)
+	{
+		GeneratorType genType;
+		if (!ParseGeneratorType(argv[2], genType))
+		{
+			std::cout << "Wrong \"generator\" parameter.\n";
+			return -1;
+		}
+
+		if (!ParseOptions(argc, argv, 5, options))
+			return -1;
+
+		int_t numVertices = 0;
+		try
+		{
+			numVertices = std::stoll(argv[3]);
+		}
+		catch (const std::exception&)
+		{
+			std::cout << "Wrong \"number of vertices\" parameter.\n";
+			return -1;
+		}
+
+		if (numVertices < 3)
+		{
+			std::cout << "The number of vertices must be at least 3.\n";
+			return -1;
+		}
+
+		return DoGenerate(genType, numVertices, argv[4], options);
+	}
+	else if (argc >= 4 && std::strncmp(argv[1], "-m", 3) == 0)
+	{
+		if (!ParseOptions(argc, argv, 4, options))
+			return -1;
+
+		return DoExportMesh(argv[2], argv[3], options);
+	}
+	else if (argc >= 4 && std::strncmp(argv[1], "-p", 3) == 0)
+	{
+		if (!ParseOptions(argc, argv, 4, options))
+			return -1;
+
+		return DoParallelBatch(argv[2], argv[3], options);
+	}
+	else if (argc >= 4 && std::strncmp(argv[1], "-i", 3) == 0)
+	{
+		if (!ParseOptions(argc, argv, 4, options))
+			return -1;
+
+		return DoImport(argv[2], argv[3], options);
+	}
+	else if (argc >= 4 && std::strncmp(argv[1], "-s", 3) == 0)
+	{
+		GeneratorType genType;
+		if (!ParseGeneratorType(argv[2], genType))
+		{
+			std::cout << "Wrong \"generator\" parameter.\n";
+			return -1;
+		}
+
+		if (!ParseOptions(argc, argv, 4, options))
+			return -1;
+
+		int_t maxVertices = 0;
+		try
+		{
+			maxVertices = std::stoll(argv[3]);
+		}
+		catch (const std::exception&)
+		{
+			std::cout << "Wrong \"maximum number of vertices\" parameter.\n";
+			return -1;
+		}
+
+		DoScaling(genType, maxVertices, options);
 	}
 	else
 	{
 		std::cout
 			<< "Wrong command line arguments.\n"
 			<< "Supply no arguments to run the GUI.\n"
-			<< "To run a benchmark: SeidelVisualize -b <polygon file> <number of iterations>\n";
+			<< "To run a benchmark: SeidelVisualize -b <polygon file or directory> <number of iterations> [-e seidel|sweep] [-order fixed|reshuffle] [-seed <n>] [-counters on|off] [-allocations on|off] [-trace <file>] [-tracedetails on|off] [-frame <ms>] [-json <file>] [-csv <file>]\n"
+			<< "To triangulate a batch with reuse of congruent polygons: SeidelVisualize -d <polygon directory> [-e seidel|sweep] [-cache <MB>]\n"
+			<< "To time loading, triangulation and saving: SeidelVisualize -x <polygon file or directory> <number of iterations> <output directory> [-e seidel|sweep] [-dropcache on|off] [-binary on|off] [-json <file>] [-csv <file>]\n"
+			<< "To triangulate many files in parallel: SeidelVisualize -p <polygon file or directory, or .txt file listing polygon files> <output directory> [-e seidel|sweep] [-format tind|btind|obj|ply|stl] [-threads <n>] [-memory <MB>] [-json <file>] [-csv <file>], exits with 0 if all files succeeded, 1 if some failed\n"
+			<< "To measure throughput on 1 to n threads: SeidelVisualize -t <polygon file or directory> <n> [-e seidel|sweep] [-trace <file>] [-tracedetails on|off] [-json <file>] [-csv <file>]\n"
+			<< "To generate a polygon: SeidelVisualize -g star|spiral|comb|hilbert|holes <number of vertices> <polygon file, .bpoly for the binary format, .qpoly for the quantized one> [-seed <n>] [-grid <size>]\n"
+			<< "To export the triangulation as a mesh: SeidelVisualize -m <polygon file> <mesh file, .obj, .ply or .stl> [-e seidel|sweep] [-rect <min x>,<min y>,<max x>,<max y>]\n"
+			<< "To import polygons from a GIS file: SeidelVisualize -i <.geojson, .wkt or .wkb file> <polygon file> [-scale <s>] [-center on|off] [-grid <size>]\n"
+			<< "To run a scaling benchmark: SeidelVisualize -s star|spiral|comb|hilbert|holes <maximum number of vertices> [-e seidel|sweep] [-order fixed|reshuffle] [-seed <n>] [-json <file>] [-csv <file>]\n";
 
 		return -1;
 	}
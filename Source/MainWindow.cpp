@@ -153,7 +153,7 @@ void MainWindow::OnSavePolyFile()
 
 void MainWindow::OnLoadPolyFile()
 {
-	auto filePath = nanogui::file_dialog({ { "poly", "Polygon File" } }, false);
+	auto filePath = nanogui::file_dialog({ { "poly", "Polygon File" }, { "bpoly", "Binary Polygon File" }, { "qpoly", "Quantized Polygon File" } }, false);
 
 	if (!filePath.empty())
 	{
@@ -209,7 +209,7 @@ void MainWindow::OnSaveTriangleIndices()
 
 	if (!indices.empty())
 	{
-		auto filePathStr = nanogui::file_dialog({ { "tind", "Triangle Indices File" } }, true);
+		auto filePathStr = nanogui::file_dialog({ { "tind", "Triangle Indices File" }, { "btind", "Binary Triangle Indices File" } }, true);
 
 		if (!filePathStr.empty())
 		{
@@ -236,7 +236,7 @@ void MainWindow::OnSaveTrianglePoints()
 
 	if (!points.empty() && !indices.empty())
 	{
-		auto filePathStr = nanogui::file_dialog({ { "tpts", "Triangle Points File" } }, true);
+		auto filePathStr = nanogui::file_dialog({ { "tpts", "Triangle Points File" }, { "btpts", "Binary Triangle Points File" } }, true);
 
 		if (!filePathStr.empty())
 		{
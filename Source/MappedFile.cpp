@@ -0,0 +1,86 @@
+#include "MappedFile.h"
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPED_FILE_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::string& fileName, Access access)
+{
+	Close();
+
+#ifdef MAPPED_FILE_MMAP
+	int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd == -1)
+		return false;
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	_size = static_cast<index_t>(fileStat.st_size);
+	if (_size > 0)
+	{
+		void* mapping = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping == MAP_FAILED)
+		{
+			close(fd);
+			_size = 0;
+			return false;
+		}
+
+		madvise(mapping, _size, (access == Access::Random) ? MADV_RANDOM : MADV_SEQUENTIAL);
+		_mapping = mapping;
+		_data = static_cast<const char*>(mapping);
+	}
+
+	// The mapping stays valid without the descriptor.
+	close(fd);
+#else
+	std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+		return false;
+
+	_size = static_cast<index_t>(file.tellg());
+	_buffer.resize(_size);
+	file.seekg(0);
+	if (!file.read(_buffer.data(), _size))
+	{
+		_buffer.clear();
+		_size = 0;
+		return false;
+	}
+
+	_data = _buffer.data();
+#endif
+
+	_isOpen = true;
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef MAPPED_FILE_MMAP
+	if (_mapping != nullptr)
+		munmap(_mapping, _size);
+#endif
+
+	_mapping = nullptr;
+	_buffer = { };
+	_data = nullptr;
+	_size = 0;
+	_isOpen = false;
+}
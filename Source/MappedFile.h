@@ -0,0 +1,42 @@
+#ifndef _MAPPED_FILE_H_
+#define _MAPPED_FILE_H_
+
+#include <string>
+#include <vector>
+#include "Common.h"
+
+
+// Read-only view of a whole file. On POSIX systems the file is memory-mapped, elsewhere it is read into
+// a buffer in one piece.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile();
+
+	// How the data will be read. Passed to the kernel as a hint for mapped files.
+	enum class Access
+	{
+		Sequential,	// Front to back, pages are read ahead.
+		Random,		// Scattered reads, only the touched pages are read.
+	};
+
+	// An empty file opens successfully with no data.
+	bool Open(const std::string& fileName, Access access = Access::Sequential);
+	void Close();
+	bool IsOpen() const { return _isOpen; }
+
+	const char* GetData() const { return _data; }
+	index_t GetSize() const { return _size; }
+
+private:
+	bool _isOpen = false;
+	const char* _data = nullptr;
+	index_t _size = 0;
+	void* _mapping = nullptr;		// Start of the mapping, if the file is mapped.
+	std::vector<char> _buffer;		// Contents of the file, if it is not mapped.
+};
+
+#endif // _MAPPED_FILE_H_
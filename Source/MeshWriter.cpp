@@ -0,0 +1,181 @@
+#include "MeshWriter.h"
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+
+// Width of the face count in the PLY header, which is written as a placeholder and overwritten at the end.
+static const int PlyCountWidth = 10;
+
+const char* GetMeshFormatName(MeshFormat format)
+{
+	switch (format)
+	{
+	case MeshFormat::OBJ:
+		return "obj";
+	case MeshFormat::PLY:
+		return "ply";
+	case MeshFormat::STL:
+		return "stl";
+	}
+
+	return "";
+}
+
+bool GetMeshFormatOfFile(const std::string& fileName, MeshFormat& format)
+{
+	auto extension = std::filesystem::path(fileName).extension().string();
+
+	for (auto f : { MeshFormat::OBJ, MeshFormat::PLY, MeshFormat::STL })
+	{
+		if (extension == std::string(".") + GetMeshFormatName(f))
+		{
+			format = f;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool MeshWriter::Open(const std::string& fileName, MeshFormat format, const CoordArray& pointCoords)
+{
+	_file.open(fileName, std::ios::binary);
+	if (!_file.is_open())
+		return false;
+
+	_format = format;
+	_pointCoords = &pointCoords;
+	_numTriangles = 0;
+
+	switch (_format)
+	{
+	case MeshFormat::OBJ:
+		for (const auto& pt : pointCoords)
+		{
+			_writer.Write("v ");
+			_writer.Write(pt.x);
+			_writer.Write(' ');
+			_writer.Write(pt.y);
+			_writer.Write(" 0\n");
+		}
+		break;
+
+	case MeshFormat::PLY:
+		_writer.Write("ply\nformat binary_little_endian 1.0\nelement vertex ");
+		_writer.Write(pointCoords.size());
+		_writer.Write("\nproperty float x\nproperty float y\nproperty float z\nelement face ");
+		_writer.Flush();
+		_countPos = _file.tellp();
+		_writer.Write(std::string(PlyCountWidth, '0').c_str());
+		_writer.Write("\nproperty list uchar int vertex_indices\nend_header\n");
+
+		for (const auto& pt : pointCoords)
+		{
+			_writer.WriteBinary(pt.x);
+			_writer.WriteBinary(pt.y);
+			_writer.WriteBinary(0.0f);
+		}
+		break;
+
+	case MeshFormat::STL:
+	{
+		char header[80] = "Triangulated polygon";
+		_writer.WriteBytes(header, sizeof(header));
+		_writer.Flush();
+		_countPos = _file.tellp();
+		_writer.WriteBinary(std::uint32_t(0));
+		break;
+	}
+	}
+
+	return _file.good();
+}
+
+void MeshWriter::AddTriangles(const index_t* indices, index_t numIndices)
+{
+	const auto& points = *_pointCoords;
+
+	for (index_t i = 0; i < numIndices; i += 3)
+	{
+		switch (_format)
+		{
+		case MeshFormat::OBJ:
+			_writer.Write("f ");
+			_writer.Write(indices[i] + 1);
+			_writer.Write(' ');
+			_writer.Write(indices[i + 1] + 1);
+			_writer.Write(' ');
+			_writer.Write(indices[i + 2] + 1);
+			_writer.Write('\n');
+			break;
+
+		case MeshFormat::PLY:
+			_writer.WriteBinary(std::uint8_t(3));
+			for (index_t v = 0; v < 3; ++v)
+				_writer.WriteBinary(static_cast<std::int32_t>(indices[i + v]));
+			break;
+
+		case MeshFormat::STL:
+		{
+			// The normal follows from the winding of the triangle.
+			const auto& a = points[indices[i]];
+			const auto& b = points[indices[i + 1]];
+			const auto& c = points[indices[i + 2]];
+			float normalZ = ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x) >= 0.0f) ? 1.0f : -1.0f;
+
+			_writer.WriteBinary(0.0f);
+			_writer.WriteBinary(0.0f);
+			_writer.WriteBinary(normalZ);
+			for (index_t v = 0; v < 3; ++v)
+			{
+				_writer.WriteBinary(points[indices[i + v]].x);
+				_writer.WriteBinary(points[indices[i + v]].y);
+				_writer.WriteBinary(0.0f);
+			}
+			_writer.WriteBinary(std::uint16_t(0));
+			break;
+		}
+		}
+	}
+
+	_numTriangles += numIndices / 3;
+}
+
+bool MeshWriter::Close()
+{
+	if (!_file.is_open())
+		return false;
+
+	bool success = _writer.Flush();
+
+	if (_format == MeshFormat::PLY)
+	{
+		char count[PlyCountWidth + 1];
+		std::snprintf(count, sizeof(count), "%0*lld", PlyCountWidth, static_cast<long long>(_numTriangles));
+		_file.seekp(_countPos);
+		_file.write(count, PlyCountWidth);
+	}
+	else if (_format == MeshFormat::STL)
+	{
+		std::uint32_t count = static_cast<std::uint32_t>(_numTriangles);
+		_file.seekp(_countPos);
+		_file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+	}
+
+	success = success && _file.good();
+	_file.close();
+	_pointCoords = nullptr;
+
+	return success;
+}
+
+bool MeshWriter::Save(const std::string& fileName, MeshFormat format, const CoordArray& pointCoords, const IndexList& triangleIndices)
+{
+	MeshWriter writer;
+	if (!writer.Open(fileName, format, pointCoords))
+		return false;
+
+	writer.AddTriangles(triangleIndices.data(), triangleIndices.size());
+
+	return writer.Close();
+}
@@ -0,0 +1,51 @@
+#ifndef _MESH_WRITER_H_
+#define _MESH_WRITER_H_
+
+#include <string>
+#include <fstream>
+#include "Triangulator.h"
+#include "BufferedWriter.h"
+
+
+enum class MeshFormat
+{
+	OBJ,	// Text, vertices followed by 1-based faces.
+	PLY,	// Binary little-endian, float vertices and int faces.
+	STL,	// Binary, every triangle with its normal and its three corners.
+};
+
+const char* GetMeshFormatName(MeshFormat format);
+// The format is chosen by the .obj, .ply or .stl extension of the file name.
+bool GetMeshFormatOfFile(const std::string& fileName, MeshFormat& format);
+
+// Streams a triangulation into a mesh file. The points are written on opening, the triangles as they arrive,
+// so that only a fixed-size buffer is kept. The counts the formats need in their headers are filled in by Close().
+// The mesh lies in the z = 0 plane.
+class MeshWriter : public Triangulator::TriangleSink
+{
+public:
+	MeshWriter() : _writer(_file) { }
+	MeshWriter(const MeshWriter&) = delete;
+	MeshWriter& operator=(const MeshWriter&) = delete;
+
+	// The points must stay valid until the writer is closed.
+	bool Open(const std::string& fileName, MeshFormat format, const CoordArray& pointCoords);
+	void AddTriangles(const index_t* indices, index_t numIndices) override;
+	// Returns false if any write failed.
+	bool Close();
+
+	int_t GetNumTriangles() const { return _numTriangles; }
+
+	// Write a complete triangle list.
+	static bool Save(const std::string& fileName, MeshFormat format, const CoordArray& pointCoords, const IndexList& triangleIndices);
+
+private:
+	std::ofstream _file;
+	BufferedWriter _writer;
+	MeshFormat _format = MeshFormat::OBJ;
+	const CoordArray* _pointCoords = nullptr;
+	int_t _numTriangles = 0;
+	std::streampos _countPos;	// Where the triangle count goes in the header.
+};
+
+#endif // _MESH_WRITER_H_
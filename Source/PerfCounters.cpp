@@ -0,0 +1,144 @@
+#include "PerfCounters.h"
+
+#ifdef __linux__
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+static int OpenCounter(PerfCounters::Counter counter, int groupFd)
+{
+	perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.disabled = (groupFd == -1) ? 1 : 0;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP;
+
+	switch (counter)
+	{
+	case PerfCounters::Counter::Cycles:
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = PERF_COUNT_HW_CPU_CYCLES;
+		break;
+	case PerfCounters::Counter::Instructions:
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+		break;
+	case PerfCounters::Counter::L1DMisses:
+		attr.type = PERF_TYPE_HW_CACHE;
+		attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+		break;
+	case PerfCounters::Counter::LLCMisses:
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = PERF_COUNT_HW_CACHE_MISSES;
+		break;
+	case PerfCounters::Counter::BranchMisses:
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+		break;
+	}
+
+	return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+}
+#endif
+
+PerfCounters::~PerfCounters()
+{
+	Close();
+}
+
+bool PerfCounters::Open()
+{
+	Close();
+
+#ifdef __linux__
+	// All counters form one group, so that they count the same instructions and are read together.
+	// The first one that opens leads the group.
+	for (index_t c = 0; c < NumCounters; ++c)
+	{
+		int fd = OpenCounter(static_cast<Counter>(c), _groupFd);
+		if (fd == -1)
+			continue;
+
+		if (_groupFd == -1)
+			_groupFd = fd;
+
+		_fds[c] = fd;
+		_readIndices[c] = _numOpen++;
+	}
+
+	if (_groupFd == -1)
+		return false;
+
+	ioctl(_groupFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(_groupFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+void PerfCounters::Close()
+{
+#ifdef __linux__
+	for (index_t c = 0; c < NumCounters; ++c)
+	{
+		if (_fds[c] != -1)
+			close(_fds[c]);
+	}
+#endif
+
+	for (index_t c = 0; c < NumCounters; ++c)
+	{
+		_fds[c] = -1;
+		_readIndices[c] = -1;
+	}
+
+	_groupFd = -1;
+	_numOpen = 0;
+}
+
+void PerfCounters::Read(Values& outValues) const
+{
+	outValues.fill(0);
+
+#ifdef __linux__
+	if (_groupFd == -1)
+		return;
+
+	// Group read format: number of counters followed by their values in the order they were opened.
+	std::uint64_t buffer[1 + NumCounters];
+	ssize_t size = read(_groupFd, buffer, sizeof(buffer));
+	if (size < static_cast<ssize_t>(sizeof(std::uint64_t) * (1 + _numOpen)))
+		return;
+
+	for (index_t c = 0; c < NumCounters; ++c)
+	{
+		if (_readIndices[c] != -1)
+			outValues[c] = buffer[1 + _readIndices[c]];
+	}
+#endif
+}
+
+const char* PerfCounters::GetCounterName(Counter counter)
+{
+	switch (counter)
+	{
+	case Counter::Cycles:
+		return "cycles";
+	case Counter::Instructions:
+		return "instructions";
+	case Counter::L1DMisses:
+		return "l1d_misses";
+	case Counter::LLCMisses:
+		return "llc_misses";
+	case Counter::BranchMisses:
+		return "branch_misses";
+	}
+
+	return "";
+}
@@ -0,0 +1,50 @@
+#ifndef _PERF_COUNTERS_H_
+#define _PERF_COUNTERS_H_
+
+#include <array>
+#include <cstdint>
+#include "Common.h"
+
+
+// Hardware performance counters of the calling thread, read through perf_event_open on Linux. Counters the CPU,
+// the kernel or its permissions don't provide are left out and read as zero. On other systems none are available.
+class PerfCounters
+{
+public:
+	enum class Counter
+	{
+		Cycles,
+		Instructions,
+		L1DMisses,
+		LLCMisses,
+		BranchMisses,
+		Count
+	};
+
+	static constexpr index_t NumCounters = static_cast<index_t>(Counter::Count);
+	using Values = std::array<std::uint64_t, NumCounters>;
+
+	PerfCounters() = default;
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+	~PerfCounters();
+
+	// Open and start the counters. Returns false if none of them is available.
+	bool Open();
+	void Close();
+	bool IsOpen() const { return _groupFd != -1; }
+	bool IsAvailable(Counter counter) const { return _readIndices[static_cast<index_t>(counter)] != -1; }
+
+	// Counts since Open(). Costs a system call.
+	void Read(Values& outValues) const;
+
+	static const char* GetCounterName(Counter counter);
+
+private:
+	int _groupFd = -1;
+	int _fds[NumCounters] = { -1, -1, -1, -1, -1 };
+	index_t _readIndices[NumCounters] = { -1, -1, -1, -1, -1 };	// Position in the group read.
+	index_t _numOpen = 0;
+};
+
+#endif // _PERF_COUNTERS_H_
@@ -1368,7 +1368,28 @@ void PolygonWidget::FinishCurrentOutline()
 		IsNewSegmentValid(_curEditedOutline.front(), true))
 	{
 		_polygonOutlines.push_back(std::move(_curEditedOutline));
-		OnPolygonOutlinesChanged();
+
+		// Thread the new outline into the existing tree instead of building it from scratch.
+		if (_triangulator != nullptr &&
+			_triangulator->AddOutline(_polygonOutlines.back()) &&
+			_triangulator->GetTreeRootNode() != nullptr)
+		{
+			_trapInfo.segmentIndices = _triangulator->GetTreeSegmentOrder();
+			_trapInfo.numSteps = _triangulator->GetTreeNumSteps();
+			_trapInfo.segmentsAdded = _trapInfo.segmentIndices.size();
+
+			_triangInfo = { };
+			_triangInfo.winding = _triangleWinding;
+			_triangulator->Triangulate(_triangInfo, _triangleIndices, _diagonalIndices, _monotoneChainsIndices);
+
+			NotifyTriangulatorUpdated();
+			NotifyPolygonAvailable();
+			CalculateDrawingData();
+		}
+		else
+		{
+			OnPolygonOutlinesChanged();
+		}
 	}
 }
 
@@ -2,14 +2,28 @@
 #include <cassert>
 #include <algorithm>
 #include <numeric>
+#include <chrono>
+#include <unordered_map>
 #include <Math/geometry.h>
 
+// Operation counters compile to nothing unless SEIDEL_STATISTICS is defined.
+#ifdef SEIDEL_STATISTICS
+#define SEIDEL_COUNT(statement) statement
+#else
+#define SEIDEL_COUNT(statement)
+#endif
+
 
 SeidelTriangulator::SeidelTriangulator(const OutlineList& outlines)
 {
 	Init(outlines);
 }
 
+SeidelTriangulator::SeidelTriangulator(const math3d::vec2f* pointCoords, const index_t* outlineOffsets, index_t numOutlines)
+{
+	Init(pointCoords, outlineOffsets, numOutlines);
+}
+
 SeidelTriangulator::~SeidelTriangulator()
 {
 	Deinit();
@@ -36,20 +50,18 @@ bool SeidelTriangulator::BuildTrapezoidTree(TrapezoidationInfo& info)
 	// If the caller did not supply the list of segment indices, generate random sequence of line segments
 	// if requested or just a sequentially increasing index list if not.
 	if (info.segmentIndices.empty())
-	{
-		info.segmentIndices.resize(_pointCoords.size());
-		std::iota(info.segmentIndices.begin(), info.segmentIndices.end(), 0);
-		if (info.randomizeSegments)
-			std::shuffle(info.segmentIndices.begin(), info.segmentIndices.end(), _rndEng);
-	}
+		GenerateSegmentOrder(info.randomizeSegments, info.segmentIndices);
 
 	// Add each segment to the tree.
-	for (index_t segInd : info.segmentIndices)
 	{
-		AddSegment(info, segInd);
+		ScopedPhase phase(Phase::SegmentThreading);
+		for (index_t segInd : info.segmentIndices)
+		{
+			AddSegment(info, segInd);
 
-		if (info.numSteps == info.maxSteps)
-			return true;
+			if (info.numSteps == info.maxSteps)
+				return true;
+		}
 	}
 
 	DetermineInsideTrapezoids(info.fillRule);
@@ -60,6 +72,12 @@ bool SeidelTriangulator::BuildTrapezoidTree(TrapezoidationInfo& info)
 	info.threadingSegmentIndex = -1;
 	info.thredingTrap = nullptr;
 
+	_treeComplete = true;
+	_treeFillRule = info.fillRule;
+	_treeRandomized = info.randomizeSegments;
+	_treeSegmentOrder = info.segmentIndices;
+	_treeNumSteps = info.numSteps;
+
 	return true;
 }
 
@@ -75,6 +93,10 @@ void SeidelTriangulator::DeleteTrapezoidTree()
 
 	_treeRootNode = nullptr;
 	_nextTrapNumber = 1;
+	_stepPhase = StepPhase::Idle;
+	_treeComplete = false;
+	_regionPieces.clear();
+	_regionChains.clear();
 
 	for (auto& pt : _points)
 		pt.node = nullptr;
@@ -88,9 +110,12 @@ bool SeidelTriangulator::Triangulate(TriangulationInfo& info, IndexList& outTria
 	if (_treeRootNode == nullptr)
 		return false;
 
+	ScopedPhase phase(Phase::Triangulation);
+
 	outTriangleIndices.clear();
 	outDiagonalIndices.clear();
 	outMonotoneChains.clear();
+	_stepPhase = StepPhase::Idle;
 
 	index_t startIndex = 0;
 	for (auto& trap : _trapezoids)
@@ -98,25 +123,12 @@ bool SeidelTriangulator::Triangulate(TriangulationInfo& info, IndexList& outTria
 
 	while (true)
 	{
-		SeidelTriangulator::Trapezoid* startTrap = nullptr;
-		for (index_t i = startIndex; i < _trapezoids.size(); ++i)
-		{
-			auto trap = _trapezoids[i];
-			if (trap->inside &&
-				!trap->visited[0] && !trap->visited[1] &&
-				trap->lower1 == nullptr && trap->lower2 == nullptr)
-			{
-				startTrap = trap;
-				startIndex = i + 1;
-				break;
-			}
-		}
+		Side side;
+		Trapezoid* startTrap = FindStartTrapezoid(startIndex, side);
 
 		if (startTrap == nullptr)
 			break;
 
-		auto& lseg = _segments[startTrap->leftSegmentIndex];
-		Side side = (lseg.upperPointIndex == startTrap->upperPointIndex) ? Side::Left : Side::Right;
 		TraverseTrapezoids(info, outTriangleIndices, outDiagonalIndices, outMonotoneChains, startTrap, side);
 
 		if (info.numSteps == info.maxSteps)
@@ -129,316 +141,377 @@ bool SeidelTriangulator::Triangulate(TriangulationInfo& info, IndexList& outTria
 	return true;
 }
 
-void SeidelTriangulator::Init(const OutlineList& outlines)
+bool SeidelTriangulator::Triangulate(FillRule fillRule, Winding winding, IndexList& outTriangleIndices)
 {
-	// Copy all points to a single array and count the total number of points.
-	int_t numPoints = 0;
-	bool invalid = false;
-	for (auto& outl : outlines)
-	{
-		int_t n = outl.size();
-		// Each outline must have at least 3 vertices.
-		if (n < 3)
-		{
-			invalid = true;
-		}
+	if (!BuildTree(fillRule))
+		return false;
 
-		_pointCoords.insert(_pointCoords.end(), outl.begin(), outl.end());
-		numPoints += n;
-	}
+	TriangulationInfo triangInfo;
+	triangInfo.winding = winding;
 
-	_points.resize(numPoints);
-	_segments.resize(numPoints);
+	return Triangulate(triangInfo, outTriangleIndices, _diagonalIndices, _monotoneChains);
+}
 
-	index_t i = 0;
-	for (auto& outl : outlines)
-	{
-		float windingSum = 0.0f;
+bool SeidelTriangulator::Triangulate(FillRule fillRule, Winding winding, TriangleSink& sink)
+{
+	if (!BuildTree(fillRule))
+		return false;
 
-		for (index_t j = 0; j < outl.size(); ++j)
-		{
-			index_t index = i + j;
-			Segment& seg = _segments[index];
-			index_t ptAIndex = j;
-			index_t ptBIndex = (j + 1) % outl.size();
+	TriangulationInfo triangInfo;
+	triangInfo.winding = winding;
+	triangInfo.triangleSink = &sink;
 
-			// Calculate polygon winding sum.
-			windingSum += (outl[ptBIndex].x - outl[ptAIndex].x) * (outl[ptBIndex].y + outl[ptAIndex].y);
+	// Holds the triangles of one chain at a time.
+	IndexList triangleIndices;
 
-			// Determine which point is lower and which is upper.
-			if (PointsVerticalRelation(outl[ptAIndex], outl[ptBIndex]) == VerticalRelation::Below)
-			{
-				seg.lowerPointIndex = i + ptAIndex;
-				seg.upperPointIndex = i + ptBIndex;
-				seg.upward = true;
-			}
-			else
-			{
-				seg.lowerPointIndex = i + ptBIndex;
-				seg.upperPointIndex = i + ptAIndex;
-				seg.upward = false;
-			}
+	return Triangulate(triangInfo, triangleIndices, _diagonalIndices, _monotoneChains);
+}
 
-			// Is the lower point located to the left of the upper point?
-			bool lowerLeft = (PointsHorizontalRelation(_pointCoords[seg.lowerPointIndex], _pointCoords[seg.upperPointIndex]) == HorizontalRelation::Left);
+bool SeidelTriangulator::TriangulateRegion(FillRule fillRule, Winding winding, const Rect& rect, IndexList& outTriangleIndices)
+{
+	outTriangleIndices.clear();
 
-			if (lowerLeft)
-			{
-				seg.leftPointIndex = seg.lowerPointIndex;
-				seg.rightPointIndex = seg.upperPointIndex;
-			}
-			else
-			{
-				seg.leftPointIndex = seg.upperPointIndex;
-				seg.rightPointIndex = seg.lowerPointIndex;
-			}
+	if (!BuildTree(fillRule))
+		return false;
 
-			seg.line = math3d::line_from_points_2d(_pointCoords[seg.lowerPointIndex], _pointCoords[seg.upperPointIndex]);
+	if (_regionPieces.empty())
+		PartitionIntoRegionPieces();
 
-			_points[index].node = nullptr;
+	// Triangles of all pieces depend on the winding.
+	if (_regionWinding != winding)
+	{
+		for (auto& piece : _regionPieces)
+			piece.triangulated = false;
+		_regionWinding = winding;
+	}
 
-			// Set segment 1-base indices for the upper and lower points. If a point is segment's right point,
-			// then mark it by setting the segment index as negative.
-			index_t segIndex = index + 1;
-			if (_points[seg.lowerPointIndex].seg1Index == 0)
-				_points[seg.lowerPointIndex].seg1Index = lowerLeft ? segIndex : -segIndex;
-			else
-				_points[seg.lowerPointIndex].seg2Index = lowerLeft ? segIndex : -segIndex;
+	FindTrapezoidsInRect(rect, _rectTrapezoids);
+	++_regionQueryNumber;
+	_diagonalIndices.clear();
 
-			if (_points[seg.upperPointIndex].seg1Index == 0)
-				_points[seg.upperPointIndex].seg1Index = lowerLeft ? -segIndex : segIndex;
-			else
-				_points[seg.upperPointIndex].seg2Index = lowerLeft ? -segIndex : segIndex;
-		}
+	TriangulationInfo info;
+	info.winding = winding;
+	IndexList monChain;
 
-		// Winding for this ouline is clockwise if the sum is greater than 0.
-		_outlinesWinding.push_back((windingSum > 0.0f) ? Winding::CW : Winding::CCW);
+	for (auto trap : _rectTrapezoids)
+	{
+		// A trapezoid split by a diagonal belongs to a different piece on each side.
+		for (index_t chainIndex : trap->monChainIndex)
+		{
+			if (chainIndex < 0)
+				continue;
+
+			auto& piece = _regionPieces[chainIndex];
+			if (piece.queryNumber == _regionQueryNumber)
+				continue;
+
+			piece.queryNumber = _regionQueryNumber;
+
+			if (!piece.triangulated)
+			{
+				piece.triangleIndices.clear();
+				monChain = _regionChains[chainIndex];
+				Triangulate(info, piece.triangleIndices, _diagonalIndices, monChain, piece.side);
+				piece.triangulated = true;
+			}
 
-		i += outl.size();
+			outTriangleIndices.insert(outTriangleIndices.end(), piece.triangleIndices.begin(), piece.triangleIndices.end());
+		}
 	}
 
-	_isSimplePolygon = !invalid && CheckIfSimplePolygon();
+	return true;
 }
 
-void SeidelTriangulator::Deinit()
+bool SeidelTriangulator::BeginSteps(FillRule fillRule, Winding winding, bool randomizeSegments)
 {
+	if (!_isSimplePolygon)
+		return false;
+
 	DeleteTrapezoidTree();
-	// Clear polygon data.
-	_pointCoords.clear();
-	_points.clear();
-	_segments.clear();
-	_outlinesWinding.clear();
 
-	_isSimplePolygon = false;
+	_stepTrapInfo = TrapezoidationInfo { };
+	_stepTrapInfo.fillRule = fillRule;
+	_stepTrapInfo.randomizeSegments = randomizeSegments;
+	GenerateSegmentOrder(randomizeSegments, _stepTrapInfo.segmentIndices);
+
+	_stepTriangInfo = TriangulationInfo { };
+	_stepTriangInfo.winding = winding;
+
+	_stepTriangleIndices.clear();
+	_diagonalIndices.clear();
+	_monotoneChains.clear();
+	_chainStack.clear();
+	_stepPosition = 0;
+	_stepPhase = StepPhase::AddingSegments;
+
+	return true;
 }
 
-bool SeidelTriangulator::CheckIfSimplePolygon()
+SeidelTriangulator::StepPhase SeidelTriangulator::Step(const StepBudget& budget)
 {
-	// Shamos-Hoey sweep line algorithm is used to detect whether any line segments intersect.
-
-	// A predicate for sorting segment point events.
-	auto sortSegPtEventsPred = [this](index_t segPt1, index_t segPt2) -> bool {
-		const auto& seg1 = _segments[std::abs(segPt1) - 1];
-		const auto& seg2 = _segments[std::abs(segPt2) - 1];
-		index_t pt1Index = (segPt1 > 0) ? seg1.leftPointIndex : seg1.rightPointIndex;
-		index_t pt2Index = (segPt2 > 0) ? seg2.leftPointIndex : seg2.rightPointIndex;
-		
-		// If it is one and the same point shared by the two segments, the one which is
-		// on the right of a segment is taken to be smaller.
-		if (pt1Index == pt2Index)
-			return (segPt1 < 0 && segPt2 > 0);
-		
-		const auto& pt1 = _pointCoords[pt1Index];
-		const auto& pt2 = _pointCoords[pt2Index];
-
-		// The point which is lexicographicaly on the left is smaller.
-		return PointsHorizontalRelation(pt1, pt2) == HorizontalRelation::Left;
-	};
+	auto startTime = std::chrono::steady_clock::now();
+	int_t numSteps = 0;
 
-	// A predicate used in std::adjacent_find(), to find two points with identical coordinates in a sorted vector.
-	// Since each point appears twice, as a left point of a segment and as a right point of another
-	// segment, we need to treat each such pair as distinct.
-	auto adjEqPred = [this](index_t segPt1, index_t segPt2) -> bool {
-		const auto& seg1 = _segments[std::abs(segPt1) - 1];
-		const auto& seg2 = _segments[std::abs(segPt2) - 1];
-		index_t pt1Index = (segPt1 > 0) ? seg1.leftPointIndex : seg1.rightPointIndex;
-		index_t pt2Index = (segPt2 > 0) ? seg2.leftPointIndex : seg2.rightPointIndex;
-
-		// If both indices refer to the same point, it means it's the shared point of the two segments.
-		// Only looking for two different points with the same coordinates.
-		if (pt1Index == pt2Index)
+	// Returns false when the budget has been spent.
+	auto withinBudget = [&]() {
+		if (budget.maxSteps >= 0 && numSteps >= budget.maxSteps)
 			return false;
 
-		return _pointCoords[pt1Index] == _pointCoords[pt2Index];
-	};
-
-	// A predicate used for finding a place to insert a segment into a sorted vector of segments.
-	// Segments are sorted by y coordinate of a new segment's left point and an intersection of
-	// a vertical line going through that point and another segment.
-	auto segOrderPred = [this](const Segment* otherSeg, const Segment* newSeg) -> bool {
-		// Find the intersection of the vertical sweep line and the other segment.
-		// If there is no intersection, use other segment's left point.
-		const auto& leftEventPt = _pointCoords[newSeg->leftPointIndex];
-		auto vertSweepLine = math3d::line_from_point_and_vec_2d(leftEventPt, math3d::vec2f_y_axis);
-		math3d::vec2f otherPt;
-		if (!math3d::intersect_lines_2d(otherPt, vertSweepLine, otherSeg->line))
-			otherPt = _pointCoords[otherSeg->leftPointIndex];
-
-		if (otherPt == leftEventPt)
+		if (budget.maxTimeMS >= 0.0)
 		{
-			// If points to be compared are the same, use right points of the segments.
-			// Return true if other segment's right point is below new segment's right point.
-			return (PointsVerticalRelation(_pointCoords[otherSeg->rightPointIndex], _pointCoords[newSeg->rightPointIndex]) == VerticalRelation::Below);
+			auto elapsed = std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - startTime);
+			if (elapsed.count() >= budget.maxTimeMS)
+				return false;
 		}
-		else
-		{
-			// Return true if other segment's point is below new segment's left point.
-			return (PointsVerticalRelation(otherPt, leftEventPt) == VerticalRelation::Below);
-		}
-	};
 
-	std::vector<const Segment*> sortedSegments;
-	std::vector<index_t> segPtEvents(_points.size() * 2);
+		return true;
+	};
 
-	for (index_t i = 0; i < _points.size(); ++i)
+	while (_stepPhase != StepPhase::Idle && _stepPhase != StepPhase::Finished && withinBudget())
 	{
-		segPtEvents[2 * i] = _points[i].seg1Index;
-		segPtEvents[2 * i + 1] = _points[i].seg2Index;
-	}
-
-	std::sort(segPtEvents.begin(), segPtEvents.end(), sortSegPtEventsPred);
+		switch (_stepPhase)
+		{
+		case StepPhase::AddingSegments:
+		{
+			if (_stepPosition < _stepTrapInfo.segmentIndices.size())
+			{
+				AddSegment(_stepTrapInfo, _stepTrapInfo.segmentIndices[_stepPosition++]);
+			}
+			else
+			{
+				_stepPhase = StepPhase::DeterminingInside;
+				_stepPosition = 0;
+				BeginClassification();
+			}
+			break;
+		}
 
-	// No two equal points are allowed.
-	auto eqIt = std::adjacent_find(segPtEvents.begin(), segPtEvents.end(), adjEqPred);
-	if (eqIt != segPtEvents.end())
-		return false;
+		case StepPhase::DeterminingInside:
+		{
+			if (!ClassifyNextTrapezoid(_stepPosition, _stepTrapInfo.fillRule))
+			{
+				for (auto trap : _trapezoids)
+					trap->visited[0] = trap->visited[1] = false;
 
-	for (index_t segIndex : segPtEvents)
-	{
-		const Segment& seg = _segments[std::abs(segIndex) - 1];
+				_stepPhase = StepPhase::Triangulating;
+				_stepPosition = 0;
+			}
+			break;
+		}
 
-		if (segIndex > 0)
+		case StepPhase::Triangulating:
 		{
-			// The point is the left endpoint of segment (starts the segment).
-			auto insertPos = std::lower_bound(sortedSegments.begin(), sortedSegments.end(), &seg, segOrderPred);
-			const Segment* nextSeg = (insertPos != sortedSegments.end()) ? *insertPos : nullptr;
-			const Segment* prevSeg = (insertPos != sortedSegments.begin()) ? *std::prev(insertPos) : nullptr;
-
-			if (prevSeg != nullptr)
+			if (_chainStack.empty())
 			{
-				if (seg.lowerPointIndex == prevSeg->lowerPointIndex || seg.upperPointIndex == prevSeg->lowerPointIndex ||
-					seg.lowerPointIndex == prevSeg->upperPointIndex || seg.upperPointIndex == prevSeg->upperPointIndex)
+				Side side;
+				Trapezoid* startTrap = FindStartTrapezoid(_stepPosition, side);
+
+				if (startTrap != nullptr)
 				{
-					// For adjacent segments use intersection test that excludes endpoints.
-					if (math3d::do_line_segments_intersect_exclude_endpoints_2d(
-						_pointCoords[seg.lowerPointIndex], _pointCoords[seg.upperPointIndex],
-						_pointCoords[prevSeg->lowerPointIndex], _pointCoords[prevSeg->upperPointIndex]))
-					{
-						return false;
-					}
+					_chainStack.emplace_back(startTrap, side);
 				}
 				else
 				{
-					if (math3d::do_line_segments_intersect_2d(
-						_pointCoords[seg.lowerPointIndex], _pointCoords[seg.upperPointIndex],
-						_pointCoords[prevSeg->lowerPointIndex], _pointCoords[prevSeg->upperPointIndex]))
-					{
-						return false;
-					}
+					// The finished tree is kept like one built by BuildTrapezoidTree.
+					_stepPhase = StepPhase::Finished;
+					_treeComplete = true;
+					_treeFillRule = _stepTrapInfo.fillRule;
+					_treeRandomized = _stepTrapInfo.randomizeSegments;
+					_treeSegmentOrder = _stepTrapInfo.segmentIndices;
+					_treeNumSteps = _stepTrapInfo.numSteps + 1;
 				}
 			}
-
-			if (nextSeg != nullptr)
+			else
 			{
-				if (seg.lowerPointIndex == nextSeg->lowerPointIndex || seg.upperPointIndex == nextSeg->lowerPointIndex ||
-					seg.lowerPointIndex == nextSeg->upperPointIndex || seg.upperPointIndex == nextSeg->upperPointIndex)
-				{
-					// For adjacent segments use intersection test that excludes endpoints.
-					if (math3d::do_line_segments_intersect_exclude_endpoints_2d(
-						_pointCoords[seg.lowerPointIndex], _pointCoords[seg.upperPointIndex],
-						_pointCoords[nextSeg->lowerPointIndex], _pointCoords[nextSeg->upperPointIndex]))
-					{
-						return false;
-					}
-				}
-				else
-				{
-					if (math3d::do_line_segments_intersect_2d(
-						_pointCoords[seg.lowerPointIndex], _pointCoords[seg.upperPointIndex],
-						_pointCoords[nextSeg->lowerPointIndex], _pointCoords[nextSeg->upperPointIndex]))
-					{
-						return false;
-					}
-				}
+				auto chainStart = _chainStack.back();
+				_chainStack.pop_back();
+				TraverseMonotoneChain(_stepTriangInfo, _stepTriangleIndices, _diagonalIndices, _monotoneChains, chainStart.first, chainStart.second);
 			}
+			break;
+		}
+		}
 
-			sortedSegments.insert(insertPos, &seg);
+		++numSteps;
+	}
+
+	return _stepPhase;
+}
+
+void SeidelTriangulator::GetTreeStatistics(TreeStatistics& outStatistics) const
+{
+	outStatistics = { };
+
+	if (_treeRootNode == nullptr)
+		return;
+
+	// Nodes can have several parents, so the longest paths are found by relaxing the depths in topological
+	// order, which is the reverse of the depth first post-order.
+	std::unordered_map<const TreeNode*, int_t> depths;
+	std::vector<const TreeNode*> postOrder;
+	std::vector<std::pair<const TreeNode*, bool>> stack;
+	stack.push_back({ _treeRootNode, false });
+
+	while (!stack.empty())
+	{
+		auto [node, childrenDone] = stack.back();
+		stack.pop_back();
+
+		if (childrenDone)
+		{
+			postOrder.push_back(node);
+			continue;
 		}
-		else
+
+		if (!depths.emplace(node, 0).second)
+			continue;
+
+		stack.push_back({ node, true });
+		for (const TreeNode* child : { node->right, node->left })
 		{
-			// The point is the right endpoint of segment (ends the segment).
-			auto segPos = std::find(sortedSegments.begin(), sortedSegments.end(), &seg);
+			if (child != nullptr && depths.find(child) == depths.end())
+				stack.push_back({ child, false });
+		}
+	}
 
-			if (segPos != sortedSegments.end())
-			{
-				const Segment* nextSeg = (std::next(segPos) != sortedSegments.end()) ? *std::next(segPos) : nullptr;
-				const Segment* prevSeg = (segPos != sortedSegments.begin()) ? *std::prev(segPos) : nullptr;
+	int_t depthSum = 0;
+	for (auto it = postOrder.rbegin(); it != postOrder.rend(); ++it)
+	{
+		const TreeNode* node = *it;
+		int_t depth = depths[node];
 
-				if (prevSeg != nullptr && nextSeg != nullptr)
-				{
-					if (prevSeg->lowerPointIndex == nextSeg->lowerPointIndex || prevSeg->upperPointIndex == nextSeg->lowerPointIndex ||
-						prevSeg->lowerPointIndex == nextSeg->upperPointIndex || prevSeg->upperPointIndex == nextSeg->upperPointIndex)
-					{
-						// For adjacent segments use intersection test that excludes endpoints.
-						if (math3d::do_line_segments_intersect_exclude_endpoints_2d(
-							_pointCoords[prevSeg->lowerPointIndex], _pointCoords[prevSeg->upperPointIndex],
-							_pointCoords[nextSeg->lowerPointIndex], _pointCoords[nextSeg->upperPointIndex]))
-						{
-							return false;
-						}
-					}
-					else
-					{
-						if (math3d::do_line_segments_intersect_2d(
-							_pointCoords[prevSeg->lowerPointIndex], _pointCoords[prevSeg->upperPointIndex],
-							_pointCoords[nextSeg->lowerPointIndex], _pointCoords[nextSeg->upperPointIndex]))
-						{
-							return false;
-						}
-					}
-				}
+		if (node->type == TreeNode::Type::Trapezoid)
+		{
+			++outStatistics.numTrapezoids;
+			outStatistics.maxDepth = std::max(outStatistics.maxDepth, depth);
+			depthSum += depth;
+			continue;
+		}
 
-				sortedSegments.erase(segPos);
-			}
-			else
-			{
-				assert(false);
-			}
+		for (const TreeNode* child : { node->left, node->right })
+		{
+			if (child != nullptr)
+				depths[child] = std::max(depths[child], depth + 1);
 		}
 	}
 
-	assert(sortedSegments.empty());
+	outStatistics.numNodes = postOrder.size();
+	outStatistics.numBytes = _trapezoids.size() * sizeof(Trapezoid) + _trapezoids.capacity() * sizeof(Trapezoid*)
+		+ _treeNodes.size() * sizeof(TreeNode) + _treeNodes.capacity() * sizeof(TreeNode*) + _points.capacity() * sizeof(Point);
+	if (outStatistics.numTrapezoids > 0)
+		outStatistics.averageDepth = static_cast<double>(depthSum) / outStatistics.numTrapezoids;
+}
 
-	return true;
+void SeidelTriangulator::SetRandomSeed(std::uint32_t seed)
+{
+	_rndEng.seed(seed);
+	_segmentOrder.clear();
+	// The next run builds a new tree with the seeded order.
+	DeleteTrapezoidTree();
+}
+
+void SeidelTriangulator::Init(const OutlineList& outlines)
+{
+	InitPolygon(outlines);
+	_points.resize(_pointCoords.size());
+}
+
+void SeidelTriangulator::Init(const math3d::vec2f* pointCoords, const index_t* outlineOffsets, index_t numOutlines)
+{
+	InitPolygon(pointCoords, outlineOffsets, numOutlines);
+	_points.resize(_pointCoords.size());
+}
+
+void SeidelTriangulator::Deinit()
+{
+	DeleteTrapezoidTree();
+	// Clear polygon data.
+	_points.clear();
+	DeinitPolygon();
+}
+
+bool SeidelTriangulator::BuildTree(FillRule fillRule)
+{
+	// A complete tree, possibly extended by AddOutline since, is reused as long as the fill rule is the same.
+	if (_treeComplete && _treeFillRule == fillRule)
+		return true;
+
+	// The random segment order is generated on the first call and reused by the later ones,
+	// so that repeated runs on the same polygon do the same amount of work.
+	TrapezoidationInfo trapInfo;
+	trapInfo.fillRule = fillRule;
+	trapInfo.segmentIndices.swap(_segmentOrder);
+
+	bool built = BuildTrapezoidTree(trapInfo);
+	_segmentOrder.swap(trapInfo.segmentIndices);
+
+	return built;
+}
+
+void SeidelTriangulator::OnPolygonEdited()
+{
+	// The tree and the cached segment order belong to the previous polygon.
+	DeleteTrapezoidTree();
+	_points.resize(_pointCoords.size());
+	_segmentOrder.clear();
+}
+
+void SeidelTriangulator::OnOutlineAdded(index_t firstSegIndex)
+{
+	_points.resize(_pointCoords.size());
+
+	IndexList newSegIndices;
+	GenerateSegmentOrder(_treeRandomized, newSegIndices);
+	newSegIndices.erase(std::remove_if(newSegIndices.begin(), newSegIndices.end(),
+		[firstSegIndex](index_t segIndex) { return segIndex < firstSegIndex; }), newSegIndices.end());
+
+	// Appending the new segments keeps the cached order valid and the previous prefix unchanged.
+	if (!_segmentOrder.empty())
+		_segmentOrder.insert(_segmentOrder.end(), newSegIndices.begin(), newSegIndices.end());
+
+	if (!_treeComplete || !_isSimplePolygon)
+	{
+		DeleteTrapezoidTree();
+		return;
+	}
+
+	// New segments are threaded into the existing tree, then all trapezoids are classified again
+	// because the new outline changes the crossing counts of the ones around it.
+	TrapezoidationInfo trapInfo;
+	{
+		ScopedPhase phase(Phase::SegmentThreading);
+		for (index_t segIndex : newSegIndices)
+			AddSegment(trapInfo, segIndex);
+	}
+
+	for (auto trap : _trapezoids)
+	{
+		trap->inside = false;
+		trap->hasDiagonal = false;
+	}
+
+	DetermineInsideTrapezoids(_treeFillRule);
+	_regionPieces.clear();
+	_regionChains.clear();
+
+	_treeSegmentOrder.insert(_treeSegmentOrder.end(), newSegIndices.begin(), newSegIndices.end());
+	_treeNumSteps += trapInfo.numSteps;
 }
 
 SeidelTriangulator::Trapezoid* SeidelTriangulator::AllocateTrapezoid()
 {
 	auto newTrap = new Trapezoid(_nextTrapNumber++);
+	newTrap->listIndex = _trapezoids.size();
 	_trapezoids.push_back(newTrap);
 	return newTrap;
 }
 
+// The last trapezoid takes the place of the removed one, so that merges don't have to search the list.
 void SeidelTriangulator::DeallocateTrapezoid(Trapezoid* trapezoid)
 {
-	for (auto it = _trapezoids.begin(); it != _trapezoids.end(); ++it)
-	{
-		if (*it == trapezoid)
-		{
-			_trapezoids.erase(it);
-			break;
-		}
-	}
+	auto lastTrap = _trapezoids.back();
+	lastTrap->listIndex = trapezoid->listIndex;
+	_trapezoids[trapezoid->listIndex] = lastTrap;
+	_trapezoids.pop_back();
 
 	delete trapezoid;
 }
@@ -446,20 +519,17 @@ void SeidelTriangulator::DeallocateTrapezoid(Trapezoid* trapezoid)
 SeidelTriangulator::TreeNode* SeidelTriangulator::AllocateTrapTreeNode()
 {
 	auto newNode = new TreeNode;
+	newNode->listIndex = _treeNodes.size();
 	_treeNodes.push_back(newNode);
 	return newNode;
 }
 
 void SeidelTriangulator::DeallocateTrapTreeNode(TreeNode* node)
 {
-	for (auto it = _treeNodes.begin(); it != _treeNodes.end(); ++it)
-	{
-		if (*it == node)
-		{
-			_treeNodes.erase(it);
-			break;
-		}
-	}
+	auto lastNode = _treeNodes.back();
+	lastNode->listIndex = node->listIndex;
+	_treeNodes[node->listIndex] = lastNode;
+	_treeNodes.pop_back();
 
 	delete node;
 }
@@ -503,17 +573,24 @@ SeidelTriangulator::Trapezoid* SeidelTriangulator::AddPoint(index_t pointIndex)
 	}
 
 	TreeNode* node = _treeRootNode;
+	SEIDEL_COUNT(int_t numNodesVisited = 0);
 
 	while (node != nullptr)
 	{
+		SEIDEL_COUNT(++numNodesVisited);
+
 		switch (node->type)
 		{
 		case TreeNode::Type::Point:
 		{
 			// If this is the same vertex, return the existing node.
 			if (pointIndex == node->elementIndex)
+			{
+				SEIDEL_COUNT(CountLocation(numNodesVisited));
 				return nullptr;
+			}
 
+			SEIDEL_COUNT(++_statistics.numPredicates);
 			auto rel = PointsVerticalRelation(_pointCoords[pointIndex], _pointCoords[node->elementIndex]);
 			node = (rel == VerticalRelation::Below) ? node->left : node->right;
 			break;
@@ -528,6 +605,8 @@ SeidelTriangulator::Trapezoid* SeidelTriangulator::AddPoint(index_t pointIndex)
 
 		case TreeNode::Type::Trapezoid:
 		{
+			SEIDEL_COUNT(CountLocation(numNodesVisited));
+
 			// We change this trapezoid node into a vertex node.
 			// We split this trapezoid in two by the horizontal line that goes through the vertex
 			// and add new trapezoid nodes as children of the vertex node.
@@ -605,6 +684,8 @@ SeidelTriangulator::TreeNode* SeidelTriangulator::ThreadSegment(
 	TreeNode*& leftTrapNode,
 	TreeNode*& rightTrapNode)
 {
+	SEIDEL_COUNT(++_statistics.numTrapezoidSplits);
+
 	TreeNode* nextTrapNode = nullptr;
 	auto leftTrap = trapNode->trapezoid;	// Reuse the trapezoid we are splitting as a new left trapezoid.
 	auto rightTrap = AllocateTrapezoid();
@@ -807,9 +888,12 @@ SeidelTriangulator::TreeNode* SeidelTriangulator::ThreadSegment(
 SeidelTriangulator::TreeNode* SeidelTriangulator::GetFirstTrapezoidForNewSegment(TreeNode* startNode, const Segment& segment)
 {
 	TreeNode* node = startNode;
+	SEIDEL_COUNT(int_t numNodesVisited = 0);
 
 	while (node != nullptr)
 	{
+		SEIDEL_COUNT(++numNodesVisited);
+
 		switch (node->type)
 		{
 		case TreeNode::Type::Point:
@@ -822,6 +906,8 @@ SeidelTriangulator::TreeNode* SeidelTriangulator::GetFirstTrapezoidForNewSegment
 
 				while (node != nullptr)
 				{
+					SEIDEL_COUNT(++numNodesVisited);
+
 					switch (node->type)
 					{
 					case TreeNode::Type::Point:
@@ -833,6 +919,7 @@ SeidelTriangulator::TreeNode* SeidelTriangulator::GetFirstTrapezoidForNewSegment
 
 					case TreeNode::Type::Trapezoid:
 					{
+						SEIDEL_COUNT(CountLocation(numNodesVisited));
 						return node;
 					}
 
@@ -866,6 +953,7 @@ SeidelTriangulator::TreeNode* SeidelTriangulator::GetFirstTrapezoidForNewSegment
 			}
 			else
 			{
+				SEIDEL_COUNT(++_statistics.numPredicates);
 				auto rel = PointsVerticalRelation(_pointCoords[segment.upperPointIndex], _pointCoords[node->elementIndex]);
 				node = (rel == VerticalRelation::Below) ? node->left : node->right;
 			}
@@ -883,6 +971,7 @@ SeidelTriangulator::TreeNode* SeidelTriangulator::GetFirstTrapezoidForNewSegment
 		case TreeNode::Type::Trapezoid:
 		{
 			// The upper point is not inserted, this is the trapezoid where it should be.
+			SEIDEL_COUNT(CountLocation(numNodesVisited));
 			return node;
 		}
 		}
@@ -902,6 +991,8 @@ SeidelTriangulator::TreeNode* SeidelTriangulator::MergeTrapezoids(TreeNode* prev
 	if (prevTrap->leftSegmentIndex == curTrap->leftSegmentIndex &&
 		prevTrap->rightSegmentIndex == curTrap->rightSegmentIndex)
 	{
+		SEIDEL_COUNT(++_statistics.numMerges);
+
 		auto l1 = curTrap->lower1;
 		auto l2 = curTrap->lower2;
 
@@ -944,6 +1035,8 @@ SeidelTriangulator::TreeNode* SeidelTriangulator::MergeTrapezoids(TreeNode* prev
 
 void SeidelTriangulator::AddSegment(TrapezoidationInfo& trapInfo, index_t segmentIndex)
 {
+	ScopedDetail detail("segment_insertion", segmentIndex);
+
 	Segment& segment = _segments[segmentIndex];
 	Trapezoid* firstTrap = nullptr;
 
@@ -987,7 +1080,6 @@ void SeidelTriangulator::AddSegment(TrapezoidationInfo& trapInfo, index_t segmen
 
 	// Thread the segment from its upper point to its lower point through trapezoids and split
 	// them in half.
-
 	TreeNode* trapezoidNode = firstTrap ? firstTrap->node : GetFirstTrapezoidForNewSegment(upperPtNode, segment);
 	TreeNode* prevLeftTrapNode = nullptr;
 	TreeNode* prevRightTrapNode = nullptr;
@@ -1021,7 +1113,70 @@ void SeidelTriangulator::AddSegment(TrapezoidationInfo& trapInfo, index_t segmen
 		++trapInfo.segmentsAdded;
 }
 
+void SeidelTriangulator::GenerateSegmentOrder(bool randomize, IndexList& outSegmentIndices)
+{
+	outSegmentIndices.resize(_segments.size());
+	std::iota(outSegmentIndices.begin(), outSegmentIndices.end(), 0);
+	if (randomize)
+		std::shuffle(outSegmentIndices.begin(), outSegmentIndices.end(), _rndEng);
+}
+
 void SeidelTriangulator::DetermineInsideTrapezoids(FillRule fillRule)
+{
+	ScopedPhase phase(Phase::InsideClassification);
+
+	BeginClassification();
+
+	index_t startIndex = 0;
+	while (ClassifyNextTrapezoid(startIndex, fillRule))
+		;
+}
+
+void SeidelTriangulator::BeginClassification()
+{
+	_classified.assign(_trapezoids.size(), false);
+	_trapStack.clear();
+}
+
+bool SeidelTriangulator::ClassifyNextTrapezoid(index_t& startIndex, FillRule fillRule)
+{
+	// Upper and lower neighbours aren't separated by a segment, so they lie in the same face of the polygon.
+	// The crossings are counted for one trapezoid of each face and the result is spread to the rest of it.
+	if (_trapStack.empty())
+	{
+		while (startIndex < _trapezoids.size() && _classified[startIndex])
+			++startIndex;
+
+		if (startIndex == _trapezoids.size())
+			return false;
+
+		auto startTrap = _trapezoids[startIndex];
+		DetermineInsideTrapezoid(startTrap, fillRule);
+		_faceInside = startTrap->inside;
+
+		_classified[startIndex] = true;
+		_trapStack.push_back(startTrap);
+	}
+
+	auto trap = _trapStack.back();
+	_trapStack.pop_back();
+
+	trap->inside = _faceInside;
+	trap->hasDiagonal = _faceInside && HasDiagonal(trap);
+
+	for (auto adjTrap : { trap->upper1, trap->upper2, trap->upper3, trap->lower1, trap->lower2 })
+	{
+		if (adjTrap != nullptr && !_classified[adjTrap->listIndex])
+		{
+			_classified[adjTrap->listIndex] = true;
+			_trapStack.push_back(adjTrap);
+		}
+	}
+
+	return true;
+}
+
+void SeidelTriangulator::DetermineInsideTrapezoid(Trapezoid* trap, FillRule fillRule)
 {
 	auto countCrossings = [this](index_t segIndex, int_t& counter) {
 		auto& segment = _segments[segIndex];
@@ -1032,162 +1187,199 @@ void SeidelTriangulator::DetermineInsideTrapezoids(FillRule fillRule)
 			counter++;
 	};
 
-	for (auto trap : _trapezoids)
+	if (trap->lowerPointIndex < 0 ||
+		trap->upperPointIndex < 0 ||
+		trap->leftSegmentIndex < 0 ||
+		trap->rightSegmentIndex < 0)
 	{
-		if (trap->lowerPointIndex < 0 ||
-			trap->upperPointIndex < 0 ||
-			trap->leftSegmentIndex < 0 ||
-			trap->rightSegmentIndex < 0)
-		{
-			continue;
-		}
+		return;
+	}
 
-		auto node = trap->node;
-		Side direction = Side::Left;
-		int_t segmentCrossCounter = 0;
+	auto node = trap->node;
+	Side direction = Side::Left;
+	int_t segmentCrossCounter = 0;
 
-		// Traverse upwards until the left or right segment of this trapezoid is encountered.
-		// The segment side determines the direction.
-		while (true)
+	// Traverse upwards until the left or right segment of this trapezoid is encountered.
+	// The segment side determines the direction.
+	while (true)
+	{
+		node = node->parent;
+
+		if (node == _treeRootNode)
 		{
-			node = node->parent;
+			assert(false);
+			return;
+		}
 
-			if (node == _treeRootNode)
+		if (node->type == TreeNode::Type::Segment)
+		{
+			if (node->elementIndex == trap->leftSegmentIndex)
 			{
-				assert(false);
-				return;
+				countCrossings(trap->leftSegmentIndex, segmentCrossCounter);
+				direction = Side::Left;
+				break;
 			}
-
-			if (node->type == TreeNode::Type::Segment)
+			else if (node->elementIndex == trap->rightSegmentIndex)
 			{
-				if (node->elementIndex == trap->leftSegmentIndex)
-				{
-					countCrossings(trap->leftSegmentIndex, segmentCrossCounter);
-					direction = Side::Left;
-					break;
-				}
-				else if (node->elementIndex == trap->rightSegmentIndex)
-				{
-					countCrossings(trap->rightSegmentIndex, segmentCrossCounter);
-					direction = Side::Right;
-					break;
-				}
+				countCrossings(trap->rightSegmentIndex, segmentCrossCounter);
+				direction = Side::Right;
+				break;
 			}
 		}
+	}
 
-		int_t pointCount = 0;
-		bool finished = false;
-		node = (direction == Side::Left) ? node->left : node->right;
+	int_t pointCount = 0;
+	bool finished = false;
+	node = (direction == Side::Left) ? node->left : node->right;
 
-		// From the segment node, traverse the tree downwards to left or right,
-		// depending on direction that was determined, until a trapezoid node
-		// is reached. This will be an adjacent trapezoid to the one we started
-		// with. Procede until a trapezoid without left or right segment is encountered.
-		while (!finished)
+	// From the segment node, traverse the tree downwards to left or right,
+	// depending on direction that was determined, until a trapezoid node
+	// is reached. This will be an adjacent trapezoid to the one we started
+	// with. Procede until a trapezoid without left or right segment is encountered.
+	while (!finished)
+	{
+		if (node == nullptr)
 		{
-			if (node == nullptr)
-			{
-				assert(false);
-				return;
-			}
+			assert(false);
+			return;
+		}
 
-			switch (node->type)
-			{
-			case TreeNode::Type::Point:
-			{
-				pointCount++;
-				node = (pointCount % 2 == 1) ? node->left : node->right;
-				break;
-			}
+		switch (node->type)
+		{
+		case TreeNode::Type::Point:
+		{
+			pointCount++;
+			node = (pointCount % 2 == 1) ? node->left : node->right;
+			break;
+		}
 
-			case TreeNode::Type::Segment:
-			{
-				node = (direction == Side::Left) ? node->right : node->left;
-				break;
-			}
+		case TreeNode::Type::Segment:
+		{
+			node = (direction == Side::Left) ? node->right : node->left;
+			break;
+		}
 
-			case TreeNode::Type::Trapezoid:
+		case TreeNode::Type::Trapezoid:
+		{
+			// We have reached an adjacent trapezoid.
+			pointCount = 0;
+			auto adjTrap = node->trapezoid;
+
+			if (adjTrap->leftSegmentIndex >= 0 && adjTrap->rightSegmentIndex >= 0)
 			{
-				// We have reached an adjacent trapezoid.
-				pointCount = 0;
-				auto adjTrap = node->trapezoid;
+				// This trapezoid has both left and right segments. Traverse upwards until the segment that matches
+				// current direction is reached.
+				index_t segmentIndex = (direction == Side::Left) ? adjTrap->leftSegmentIndex : adjTrap->rightSegmentIndex;
 
-				if (adjTrap->leftSegmentIndex >= 0 && adjTrap->rightSegmentIndex >= 0)
+				while (true)
 				{
-					// This trapezoid has both left and right segments. Traverse upwards until the segment that matches
-					// current direction is reached.
-					index_t segmentIndex = (direction == Side::Left) ? adjTrap->leftSegmentIndex : adjTrap->rightSegmentIndex;
+					node = node->parent;
 
-					while (true)
+					if (node == _treeRootNode)
 					{
-						node = node->parent;
-
-						if (node == _treeRootNode)
-						{
-							assert(false);
-							return;
-						}
-
-						if (node->type == TreeNode::Type::Segment &&
-							node->elementIndex == segmentIndex)
-						{
-							countCrossings(segmentIndex, segmentCrossCounter);
-							break;
-						}
+						assert(false);
+						return;
 					}
 
-					node = (direction == Side::Left) ? node->left : node->right;
+					if (node->type == TreeNode::Type::Segment &&
+						node->elementIndex == segmentIndex)
+					{
+						countCrossings(segmentIndex, segmentCrossCounter);
+						break;
+					}
 				}
-				else
+
+				node = (direction == Side::Left) ? node->left : node->right;
+			}
+			else
+			{
+				// We have reached a trapezoid which is outside the polygon. Set the trapezoid status according to the fill rule.
+				switch (fillRule)
 				{
-					// Helper function to test whether a trapezoid has a diagonal.
-					auto hasDiagonal = [this](Trapezoid* trap) -> bool
+				case FillRule::NonZero:
+					if (segmentCrossCounter != 0)
 					{
-						// A diagonal can be drawn between upper and lower points when those points are not on the same segment.
+						trap->inside = true;
+						trap->hasDiagonal = HasDiagonal(trap);
+					}
+					break;
 
-						index_t lpi = trap->lowerPointIndex;
-						index_t upi = trap->upperPointIndex;
+				case FillRule::EvenOdd:
+					if ((segmentCrossCounter & 1) == 1)
+					{
+						trap->inside = true;
+						trap->hasDiagonal = HasDiagonal(trap);
+					}
+					break;
+				}
 
-						auto& lseg = _segments[trap->leftSegmentIndex];
-						auto& rseg = _segments[trap->rightSegmentIndex];
+				finished = true;
+			}
 
-						return
-							(lseg.lowerPointIndex != lpi || lseg.upperPointIndex != upi) &&
-							(rseg.lowerPointIndex != lpi || rseg.upperPointIndex != upi);
-					};
+			break;
+		}
+		}
+	}
+}
 
-					// We have reached a trapezoid which is outside the polygon. Set the trapezoid status according to the fill rule.
-					switch (fillRule)
-					{
-					case FillRule::NonZero:
-						if (segmentCrossCounter != 0)
-						{
-							trap->inside = true;
-							trap->hasDiagonal = hasDiagonal(trap);
-						}
-						break;
+// A diagonal can be drawn between upper and lower points when those points are not on the same segment.
+bool SeidelTriangulator::HasDiagonal(const Trapezoid* trap) const
+{
+	index_t lpi = trap->lowerPointIndex;
+	index_t upi = trap->upperPointIndex;
 
-					case FillRule::EvenOdd:
-						if ((segmentCrossCounter & 1) == 1)
-						{
-							trap->inside = true;
-							trap->hasDiagonal = hasDiagonal(trap);
-						}
-						break;
-					}
+	auto& lseg = _segments[trap->leftSegmentIndex];
+	auto& rseg = _segments[trap->rightSegmentIndex];
 
-					finished = true;
-				}
+	return
+		(lseg.lowerPointIndex != lpi || lseg.upperPointIndex != upi) &&
+		(rseg.lowerPointIndex != lpi || rseg.upperPointIndex != upi);
+}
 
-				break;
-			}
-			}
+// Find the next inside trapezoid without lower neighbours that hasn't been visited yet, starting the search at
+// startIndex. Such a trapezoid is at the bottom of a monotone polygon.
+SeidelTriangulator::Trapezoid* SeidelTriangulator::FindStartTrapezoid(index_t& startIndex, Side& monChainSide)
+{
+	for (index_t i = startIndex; i < _trapezoids.size(); ++i)
+	{
+		auto trap = _trapezoids[i];
+		if (trap->inside &&
+			!trap->visited[0] && !trap->visited[1] &&
+			trap->lower1 == nullptr && trap->lower2 == nullptr)
+		{
+			startIndex = i + 1;
+			auto& lseg = _segments[trap->leftSegmentIndex];
+			monChainSide = (lseg.upperPointIndex == trap->upperPointIndex) ? Side::Left : Side::Right;
+			return trap;
 		}
 	}
+
+	startIndex = _trapezoids.size();
+	return nullptr;
 }
 
 void SeidelTriangulator::TraverseTrapezoids(TriangulationInfo& info, IndexList& outTriangleIndices, IndexList& outDiagonalIndices, std::vector<IndexList>& outMonotoneChains, Trapezoid* trap, Side monChainSide)
 {
+	// Monotone chains are processed depth first. Trapezoids with diagonals that start chains on their
+	// other side are kept on a stack.
+	_chainStack.clear();
+	_chainStack.emplace_back(trap, monChainSide);
+
+	while (!_chainStack.empty())
+	{
+		auto chainStart = _chainStack.back();
+		_chainStack.pop_back();
+		TraverseMonotoneChain(info, outTriangleIndices, outDiagonalIndices, outMonotoneChains, chainStart.first, chainStart.second);
+
+		if (info.numSteps == info.maxSteps)
+			return;
+	}
+}
+
+void SeidelTriangulator::TraverseMonotoneChain(TriangulationInfo& info, IndexList& outTriangleIndices, IndexList& outDiagonalIndices, std::vector<IndexList>& outMonotoneChains, Trapezoid* trap, Side monChainSide)
+{
+	ScopedDetail detail("monotone_chain", outMonotoneChains.size());
+
 	// Search down until a the lowest trapezoid of the monotone polygon is found,
 	// that is the one who's lower point is the same as the lower point of the single segment.
 	index_t singleSegInd = (monChainSide == Side::Left) ? trap->rightSegmentIndex : trap->leftSegmentIndex;
@@ -1247,6 +1439,7 @@ void SeidelTriangulator::TraverseTrapezoids(TriangulationInfo& info, IndexList&
 			if (!trap->visited[vi])
 			{
 				trap->visited[vi] = true;
+				trap->monChainIndex[vi] = outMonotoneChains.size();
 				if (trap->hasDiagonal && !trap->visited[ovi])
 				{
 					outDiagonalIndices.push_back(trap->upperPointIndex);
@@ -1261,6 +1454,7 @@ void SeidelTriangulator::TraverseTrapezoids(TriangulationInfo& info, IndexList&
 			if (!trap->visited[vi])
 			{
 				trap->visited[vi] = true;
+				trap->monChainIndex[vi] = outMonotoneChains.size();
 				if (trap->hasDiagonal && !trap->visited[ovi])
 				{
 					outDiagonalIndices.push_back(trap->upperPointIndex);
@@ -1274,19 +1468,25 @@ void SeidelTriangulator::TraverseTrapezoids(TriangulationInfo& info, IndexList&
 
 	assert(monChainVerts.size() > 2);
 	outMonotoneChains.push_back(monChainVerts);
+	SEIDEL_COUNT(CountChain(monChainVerts.size()));
 
-	Triangulate(info, outTriangleIndices, outDiagonalIndices, monChainVerts, monChainSide);
+	if (_deferChainTriangulation)
+		_regionPieces.push_back({ monChainSide });
+	else
+		Triangulate(info, outTriangleIndices, outDiagonalIndices, monChainVerts, monChainSide);
+
+	if (info.triangleSink != nullptr && !outTriangleIndices.empty())
+	{
+		info.triangleSink->AddTriangles(outTriangleIndices.data(), outTriangleIndices.size());
+		outTriangleIndices.clear();
+	}
 
 	if (info.numSteps == info.maxSteps)
 		return;
 
-	for (auto trap : recurseTrapezoids)
-	{
-		TraverseTrapezoids(info, outTriangleIndices, outDiagonalIndices, outMonotoneChains, trap, otherSide);
-
-		if (info.numSteps == info.maxSteps)
-			return;
-	}
+	// Push in reverse, so that the chains are taken off the stack in the order they were found.
+	for (auto it = recurseTrapezoids.rbegin(); it != recurseTrapezoids.rend(); ++it)
+		_chainStack.emplace_back(*it, otherSide);
 }
 
 void SeidelTriangulator::Triangulate(TriangulationInfo& info, IndexList& outTriangleIndices, IndexList& outDiagonalIndices, IndexList& monChain, Side monChainSide)
@@ -1363,36 +1563,137 @@ void SeidelTriangulator::Triangulate(TriangulationInfo& info, IndexList& outTria
 	}
 }
 
-SeidelTriangulator::VerticalRelation SeidelTriangulator::PointsVerticalRelation(const math3d::vec2f& queryPoint, const math3d::vec2f& inRelationToPoint)
+// Traverse all monotone chains without triangulating them. Each trapezoid gets the index of its chain.
+void SeidelTriangulator::PartitionIntoRegionPieces()
 {
-	// If two points have the same y coordinate, then the queryPoint is considered
-	// below the inRelationToPoint if it's x coordinate is smaller.
-	if (queryPoint.y < inRelationToPoint.y)
-		return VerticalRelation::Below;
-	else if (queryPoint.y > inRelationToPoint.y)
-		return VerticalRelation::Above;
-	else if (queryPoint.x < inRelationToPoint.x)
-		return VerticalRelation::Below;
-	else
-		return VerticalRelation::Above;
+	TriangulationInfo info;
+	IndexList triangleIndices;
+	index_t startIndex = 0;
+
+	_regionPieces.clear();
+	_regionChains.clear();
+	_diagonalIndices.clear();
+	_stepPhase = StepPhase::Idle;
+
+	for (auto& trap : _trapezoids)
+	{
+		trap->visited[0] = trap->visited[1] = false;
+		trap->monChainIndex[0] = trap->monChainIndex[1] = -1;
+	}
+
+	_deferChainTriangulation = true;
+
+	while (true)
+	{
+		Side side;
+		Trapezoid* startTrap = FindStartTrapezoid(startIndex, side);
+
+		if (startTrap == nullptr)
+			break;
+
+		TraverseTrapezoids(info, triangleIndices, _diagonalIndices, _regionChains, startTrap, side);
+	}
+
+	_deferChainTriangulation = false;
 }
 
-SeidelTriangulator::HorizontalRelation SeidelTriangulator::PointsHorizontalRelation(const math3d::vec2f& queryPoint, const math3d::vec2f& inRelationToPoint)
+// Collect the inside trapezoids that may intersect the rectangle by descending the tree on every side of
+// a point or segment node the rectangle reaches.
+void SeidelTriangulator::FindTrapezoidsInRect(const Rect& rect, std::vector<Trapezoid*>& outTrapezoids)
 {
-	if (queryPoint.x < inRelationToPoint.x)
-		return HorizontalRelation::Left;
-	else if (queryPoint.x > inRelationToPoint.x)
-		return HorizontalRelation::Right;
-	else if (queryPoint.y < inRelationToPoint.y)
-		return HorizontalRelation::Left;
-	else
-		return HorizontalRelation::Right;
+	outTrapezoids.clear();
+	_visitedNodes.clear();
+	_nodeStack.clear();
+
+	if (_treeRootNode != nullptr)
+		_nodeStack.push_back(_treeRootNode);
+
+	while (!_nodeStack.empty())
+	{
+		auto node = _nodeStack.back();
+		_nodeStack.pop_back();
+
+		// Nodes are shared between paths in the tree.
+		if (!_visitedNodes.insert(node).second)
+			continue;
+
+		switch (node->type)
+		{
+		case TreeNode::Type::Point:
+		{
+			float y = _pointCoords[node->elementIndex].y;
+			if (rect.min.y <= y)
+				_nodeStack.push_back(node->left);
+			if (rect.max.y >= y)
+				_nodeStack.push_back(node->right);
+			break;
+		}
+
+		case TreeNode::Type::Segment:
+		{
+			bool right;
+			if (IsRectLeftOfSegment(rect, _segments[node->elementIndex], right))
+				_nodeStack.push_back(node->left);
+			if (right)
+				_nodeStack.push_back(node->right);
+			break;
+		}
+
+		case TreeNode::Type::Trapezoid:
+		{
+			if (node->trapezoid->inside)
+				outTrapezoids.push_back(node->trapezoid);
+			break;
+		}
+		}
+	}
+}
+
+// Test whether parts of the rectangle lie on the left and on the right side of the segment, within the segment's
+// vertical extent. Horizontal segments and rectangles outside the extent are reported on both sides.
+bool SeidelTriangulator::IsRectLeftOfSegment(const Rect& rect, const Segment& segment, bool& outRectRightOfSegment) const
+{
+	const auto& lowerPt = _pointCoords[segment.lowerPointIndex];
+	const auto& upperPt = _pointCoords[segment.upperPointIndex];
+	double minY = std::max(rect.min.y, lowerPt.y);
+	double maxY = std::min(rect.max.y, upperPt.y);
+
+	outRectRightOfSegment = true;
+
+	if (lowerPt.y == upperPt.y || minY > maxY)
+		return true;
+
+	double invSlope = (static_cast<double>(upperPt.x) - lowerPt.x) / (static_cast<double>(upperPt.y) - lowerPt.y);
+	double x1 = lowerPt.x + (minY - lowerPt.y) * invSlope;
+	double x2 = lowerPt.x + (maxY - lowerPt.y) * invSlope;
+
+	outRectRightOfSegment = (rect.max.x >= std::min(x1, x2));
+	return (rect.min.x <= std::max(x1, x2));
 }
 
 SeidelTriangulator::Side SeidelTriangulator::WhichSegmentSide(const math3d::vec2f& point, const SeidelTriangulator::Segment& segment)
 {
+	SEIDEL_COUNT(++_statistics.numPredicates);
+
 	if (math3d::point_to_line_sgn_dist_2d(point, segment.line) > 0.0f)
 		return Side::Left;
 	else
 		return Side::Right;
 }
+
+void SeidelTriangulator::CountLocation(int_t numNodesVisited)
+{
+	++_statistics.numPointLocations;
+	_statistics.numNodesVisited += numNodesVisited;
+	_statistics.maxLocationDepth = std::max(_statistics.maxLocationDepth, numNodesVisited);
+}
+
+void SeidelTriangulator::CountChain(index_t chainLength)
+{
+	index_t bucket = 0;
+	while (bucket + 1 < Statistics::NumChainLengthBuckets && (index_t(2) << bucket) <= chainLength)
+		++bucket;
+
+	++_statistics.numMonotoneChains;
+	++_statistics.chainLengthHistogram[bucket];
+}
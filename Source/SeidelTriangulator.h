@@ -3,53 +3,21 @@
 
 #include <vector>
 #include <random>
-#include <Math/vec2.h>
-#include <Math/vec3.h>
-#include "Common.h"
+#include <utility>
+#include <unordered_set>
+#include "Triangulator.h"
 
-using Outline = std::vector<math3d::vec2f>;
-using OutlineList = std::vector<Outline>;
-using IndexList = std::vector<index_t>;
 
-
-class SeidelTriangulator
+class SeidelTriangulator : public Triangulator
 {
 public:
 	struct TreeNode;
 
-	enum class FillRule
-	{
-		NonZero,
-		EvenOdd,
-	};
-
-	enum class Winding
-	{
-		CW,
-		CCW,
-	};
-
 	struct Point
 	{
-		// 1-based indices of segments that share this point.
-		// If the point is left point of the segment, the index is positive.
-		// If it is right point of the segment, the index is negative.
-		index_t seg1Index = 0;
-		index_t seg2Index = 0;
-
 		TreeNode* node = nullptr;
 	};
 
-	struct Segment
-	{
-		index_t upperPointIndex;
-		index_t lowerPointIndex;
-		index_t leftPointIndex;
-		index_t rightPointIndex;
-		math3d::vec3f line;
-		bool upward;
-	};
-
 	struct Trapezoid
 	{
 		Trapezoid(int_t num)
@@ -76,6 +44,8 @@ public:
 		bool inside = false;
 		bool visited[2] = { false, false };
 		bool hasDiagonal = false;
+		index_t monChainIndex[2] = { -1, -1 };	// Monotone chain this trapezoid belongs to on each side.
+		index_t listIndex = -1;					// Position in the trapezoid list.
 
 		const int_t number;
 	};
@@ -100,6 +70,7 @@ public:
 		TreeNode* left = nullptr;
 		TreeNode* right = nullptr;
 		TreeNode* parent = nullptr;
+		index_t listIndex = -1;	// Position in the node list.
 	};
 
 	struct TrapezoidationInfo
@@ -132,48 +103,129 @@ public:
 		// Input parameters.
 		Winding winding;
 		int_t maxSteps = -1;
+		TriangleSink* triangleSink = nullptr;	// Takes the triangles of each chain out of the output list.
 
 		// Output data.
 		int_t numSteps = 0;
 		State state = State::Undefined;
 	};
 
+	enum class StepPhase
+	{
+		Idle,
+		AddingSegments,
+		DeterminingInside,
+		Triangulating,
+		Finished
+	};
+
+	struct Rect
+	{
+		math3d::vec2f min;
+		math3d::vec2f max;
+	};
+
+	struct StepBudget
+	{
+		// A step is one segment insertion, one trapezoid classification or one monotone chain.
+		// Negative values mean there is no limit.
+		int_t maxSteps = -1;
+		double maxTimeMS = -1.0;
+	};
+
+	// Operation counts, collected only in builds with SEIDEL_STATISTICS defined. They accumulate from
+	// construction or the last ResetStatistics() call.
+	struct Statistics
+	{
+		static constexpr index_t NumChainLengthBuckets = 24;
+
+		int_t numPointLocations = 0;	// Searches of the tree for a point, including the start of each segment.
+		int_t numNodesVisited = 0;		// Nodes passed in all the searches.
+		int_t maxLocationDepth = 0;		// Most nodes passed in a single search, the deepest path actually taken.
+		int_t numTrapezoidSplits = 0;	// Trapezoids split by ThreadSegment().
+		int_t numMerges = 0;			// Trapezoids merged by MergeTrapezoids().
+		int_t numPredicates = 0;		// Point to segment and point to point comparisons.
+		int_t numMonotoneChains = 0;
+		int_t chainLengthHistogram[NumChainLengthBuckets] = { };	// Bucket k counts chains of 2^k to 2^(k+1)-1 vertices.
+	};
+
+	struct TreeStatistics
+	{
+		int_t numNodes = 0;			// Distinct nodes reachable from the root, trapezoids included.
+		int_t numTrapezoids = 0;
+		int_t maxDepth = 0;			// Longest path from the root to a trapezoid.
+		double averageDepth = 0.0;	// Longest path to each trapezoid, averaged over all trapezoids.
+		int_t numBytes = 0;			// Memory of the trapezoids, the nodes, the point entries and the lists holding them.
+	};
+
 	SeidelTriangulator(const OutlineList& outlines);
+	// Uses the coordinates in place, they must outlive the triangulator.
+	SeidelTriangulator(const math3d::vec2f* pointCoords, const index_t* outlineOffsets, index_t numOutlines);
 	~SeidelTriangulator();
 
-	bool IsSimplePolygon() const { return _isSimplePolygon; }
 	const TreeNode* GetTreeRootNode() const { return _treeRootNode; }
-	const std::vector<Segment>& GetLineSegments() const { return _segments; }
 	const std::vector<Trapezoid*>& GetTrapezoids() const { return _trapezoids; }
-	const std::vector<math3d::vec2f>& GetPointCoords() const { return _pointCoords; }
-	const std::vector<Winding>& GetOutlinesWinding() const { return _outlinesWinding; }
+	// Segment order and number of steps that rebuild the current tree, kept up to date when outlines are added.
+	const IndexList& GetTreeSegmentOrder() const { return _treeSegmentOrder; }
+	int_t GetTreeNumSteps() const { return _treeNumSteps; }
+	void GetTreeStatistics(TreeStatistics& outStatistics) const;
+
+	static constexpr bool HasStatistics()
+	{
+#ifdef SEIDEL_STATISTICS
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	const Statistics& GetStatistics() const { return _statistics; }
+	void ResetStatistics() { _statistics = { }; }
+
+	// Reseed the generator of the random segment order, so that runs can be repeated. The current tree is
+	// discarded, the seed takes effect with the next tree built from a generated order.
+	void SetRandomSeed(std::uint32_t seed);
 
 	bool BuildTrapezoidTree(TrapezoidationInfo& info);
 	void DeleteTrapezoidTree();
 	bool Triangulate(TriangulationInfo& info, IndexList& outTriangleIndices, IndexList& outDiagonalIndices, std::vector<IndexList>& outMonotoneChains);
+	bool Triangulate(FillRule fillRule, Winding winding, IndexList& outTriangleIndices) override;
+	bool Triangulate(FillRule fillRule, Winding winding, TriangleSink& sink) override;
 
-private:
-	enum class VerticalRelation
-	{
-		Above,
-		Below
-	};
+	// Output the triangles of the monotone pieces that intersect the rectangle. Pieces are triangulated on demand
+	// and their triangles are kept, so overlapping queries reuse earlier work. The tree is built only if there is
+	// none yet for this fill rule.
+	bool TriangulateRegion(FillRule fillRule, Winding winding, const Rect& rect, IndexList& outTriangleIndices);
+
+	// Resumable trapezoidation and triangulation. Each call to Step() continues where the previous one stopped,
+	// until the budget is spent. Building the tree or triangulating by other means cancels the run.
+	bool BeginSteps(FillRule fillRule, Winding winding, bool randomizeSegments = true);
+	StepPhase Step(const StepBudget& budget);
+	StepPhase GetStepPhase() const { return _stepPhase; }
+	const IndexList& GetStepTriangleIndices() const { return _stepTriangleIndices; }
 
-	enum class HorizontalRelation
+private:
+	enum class Side
 	{
 		Left,
 		Right
 	};
 
-	enum class Side
+	struct RegionPiece
 	{
-		Left,
-		Right
+		Side side;
+		IndexList triangleIndices;
+		bool triangulated = false;
+		int_t queryNumber = 0;
 	};
 
 	void Init(const OutlineList& outlines);
+	void Init(const math3d::vec2f* pointCoords, const index_t* outlineOffsets, index_t numOutlines);
 	void Deinit();
-	bool CheckIfSimplePolygon();
+	bool BuildTree(FillRule fillRule);
+
+	void OnPolygonEdited() override;
+	void OnOutlineAdded(index_t firstSegIndex) override;
 
 	// Trapezoidation functions.
 	Trapezoid* AllocateTrapezoid();
@@ -185,26 +237,74 @@ private:
 	TreeNode* GetFirstTrapezoidForNewSegment(TreeNode* startNode, const Segment& segment);
 	TreeNode* MergeTrapezoids(TreeNode* prevTrapNode, TreeNode* curTrapNode);
 	void AddSegment(TrapezoidationInfo& trapInfo, index_t segmentIndex);
+	void GenerateSegmentOrder(bool randomize, IndexList& outSegmentIndices);
 	void DetermineInsideTrapezoids(FillRule fillRule);
+	void BeginClassification();
+	// Classifies one trapezoid, continuing the flood of the current face or starting the next face at startIndex
+	// or after it. Returns false when all trapezoids are classified.
+	bool ClassifyNextTrapezoid(index_t& startIndex, FillRule fillRule);
+	void DetermineInsideTrapezoid(Trapezoid* trap, FillRule fillRule);
+	bool HasDiagonal(const Trapezoid* trap) const;
 
 	// Triangulation functions.
+	Trapezoid* FindStartTrapezoid(index_t& startIndex, Side& monChainSide);
 	void TraverseTrapezoids(TriangulationInfo& info, IndexList& outTriangleIndices, IndexList& outDiagonalIndices, std::vector<IndexList>& outMonotoneChains, Trapezoid* trap, Side monChainSide);
+	void TraverseMonotoneChain(TriangulationInfo& info, IndexList& outTriangleIndices, IndexList& outDiagonalIndices, std::vector<IndexList>& outMonotoneChains, Trapezoid* trap, Side monChainSide);
 	void Triangulate(TriangulationInfo& info, IndexList& outTriangleIndices, IndexList& outDiagonalIndices, IndexList& monChain, Side monChainSide);
 
-	static VerticalRelation PointsVerticalRelation(const math3d::vec2f& queryPoint, const math3d::vec2f& inRelationToPoint);
-	static HorizontalRelation PointsHorizontalRelation(const math3d::vec2f& queryPoint, const math3d::vec2f& inRelationToPoint);
-	static Side WhichSegmentSide(const math3d::vec2f& point, const Segment& segment);
+	// Region query functions.
+	void PartitionIntoRegionPieces();
+	void FindTrapezoidsInRect(const Rect& rect, std::vector<Trapezoid*>& outTrapezoids);
+	bool IsRectLeftOfSegment(const Rect& rect, const Segment& segment, bool& outRectRightOfSegment) const;
+
+	// Point to segment test, counted as a predicate evaluation.
+	Side WhichSegmentSide(const math3d::vec2f& point, const Segment& segment);
+
+	// Statistics functions, called only through SEIDEL_COUNT.
+	void CountLocation(int_t numNodesVisited);
+	void CountChain(index_t chainLength);
 
-	std::vector<math3d::vec2f> _pointCoords;
 	std::vector<Point> _points;
-	std::vector<Segment> _segments;
 	std::vector<TreeNode*> _treeNodes;
 	std::vector<Trapezoid*> _trapezoids;
-	std::vector<Winding> _outlinesWinding;
 	TreeNode* _treeRootNode = nullptr;
 	std::mt19937 _rndEng { std::random_device{}() };
 	int_t _nextTrapNumber = 1;
-	bool _isSimplePolygon = false;
+	std::vector<std::pair<Trapezoid*, Side>> _chainStack;
+	std::vector<Trapezoid*> _trapStack;
+	std::vector<bool> _classified;	// Trapezoids reached by the classification flood, by list index.
+	bool _faceInside = false;		// Classification of the face being flooded.
+
+	// Set when the tree is complete and its trapezoids have been classified with _treeFillRule.
+	bool _treeComplete = false;
+	FillRule _treeFillRule = FillRule::EvenOdd;
+	bool _treeRandomized = true;
+	IndexList _treeSegmentOrder;
+	int_t _treeNumSteps = 0;
+
+	// Segment order and scratch outputs used by the generic Triangulate().
+	IndexList _segmentOrder;
+	IndexList _diagonalIndices;
+	std::vector<IndexList> _monotoneChains;
+
+	// Monotone pieces for region queries. Chains are traversed once per tree, pieces are triangulated on demand.
+	std::vector<RegionPiece> _regionPieces;
+	std::vector<IndexList> _regionChains;
+	Winding _regionWinding = Winding::CCW;
+	int_t _regionQueryNumber = 0;
+	bool _deferChainTriangulation = false;
+	std::vector<const TreeNode*> _nodeStack;
+	std::vector<Trapezoid*> _rectTrapezoids;
+	std::unordered_set<const TreeNode*> _visitedNodes;
+
+	Statistics _statistics;
+
+	// State of the resumable run.
+	StepPhase _stepPhase = StepPhase::Idle;
+	TrapezoidationInfo _stepTrapInfo;
+	TriangulationInfo _stepTriangInfo;
+	index_t _stepPosition = 0;
+	IndexList _stepTriangleIndices;
 };
 
 #endif // _SEIDEL_TRIANGULATOR_H_
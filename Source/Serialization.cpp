@@ -1,36 +1,501 @@
 #include "Serialization.h"
 #include <fstream>
-#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <thread>
+#include "MappedFile.h"
+#include "BinaryPolyFile.h"
+#include "BufferedWriter.h"
 
-bool LoadPolyFile(const std::string& polyFile, OutlineList& outlines)
+static const char BinaryIndicesMagic[4] = { 'B', 'T', 'I', 'N' };
+static const char BinaryPointsMagic[4] = { 'B', 'T', 'P', 'T' };
+
+// Binary file with a header of the magic, the version, the element size and the number of elements, followed by
+// the raw array. The values are in the byte order of the machine, little-endian on all supported platforms.
+template <class _T>
+static bool WriteBinaryArray(std::ofstream& file, const char (&magic)[4], const _T* elements, index_t numElements)
 {
-	std::ifstream file(polyFile);
-	if (!file.is_open())
-		return false;
+	const std::uint16_t version = 1;
+	const std::uint16_t elementSize = sizeof(_T);
+	const std::int64_t count = numElements;
 
-	Outline points;
-	std::string line;
-	while (std::getline(file, line))
+	file.write(magic, sizeof(magic));
+	file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	file.write(reinterpret_cast<const char*>(&elementSize), sizeof(elementSize));
+	file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+	file.write(reinterpret_cast<const char*>(elements), numElements * sizeof(_T));
+
+	return file.good();
+}
+
+// Quantized .qpoly format, little-endian:
+//   header:   char magic[4] = "QPLY", uint16 version, uint16 reserved, double grid size, int64 outlines, int64 points,
+//             int64 size of the counts, int64 size of the values
+//   counts:   number of points of each outline as LEB128 varints
+//   controls: two bits per value, the lowest first, holding the number of bytes of the value minus one
+//   values:   the x and y differences of each point to the previous one, for the first point of an outline to the
+//             first point of the previous outline, zig-zag encoded in 1 to 4 bytes
+// The coordinates are integer multiples of the grid size. As the lengths are apart from the values, the position of
+// each value is known without decoding the ones before it.
+struct QuantizedPolyHeader
+{
+	char magic[4];
+	std::uint16_t version;
+	std::uint16_t reserved;
+	double gridSize;
+	std::int64_t numOutlines;
+	std::int64_t numPoints;
+	std::int64_t countsSize;
+	std::int64_t valuesSize;
+};
+
+static_assert(sizeof(QuantizedPolyHeader) == 48, "The header must have no padding.");
+
+static const char QuantizedPolyMagic[4] = { 'Q', 'P', 'L', 'Y' };
+static const std::uint16_t QuantizedPolyVersion = 1;
+
+// Quantized coordinates must be smaller, so that every zig-zag encoded difference fits into 4 bytes.
+static const double QuantizedCoordLimit = 1073741824.0;	// 2^30
+
+static std::uint32_t EncodeZigZag(std::int32_t value)
+{
+	return (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31);
+}
+
+static std::int32_t DecodeZigZag(std::uint32_t value)
+{
+	return static_cast<std::int32_t>(value >> 1) ^ -static_cast<std::int32_t>(value & 1);
+}
+
+static void WriteVarint(std::vector<unsigned char>& bytes, std::uint64_t value)
+{
+	for (; value >= 0x80; value >>= 7)
+		bytes.push_back(static_cast<unsigned char>(value | 0x80));
+	bytes.push_back(static_cast<unsigned char>(value));
+}
+
+static bool ReadVarint(const unsigned char*& pos, const unsigned char* end, std::uint64_t& value)
+{
+	value = 0;
+	for (int shift = 0; shift < 64 && pos < end; shift += 7)
+	{
+		unsigned char byte = *pos++;
+		value |= std::uint64_t(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+// Appends the value in as few bytes as it needs and records their number in the controls.
+static void WriteQuantizedValue(std::uint32_t value, index_t valueIndex, std::vector<unsigned char>& controls, std::vector<unsigned char>& values)
+{
+	int length = (value < 0x100) ? 1 : (value < 0x10000) ? 2 : (value < 0x1000000) ? 3 : 4;
+	if (valueIndex % 4 == 0)
+		controls.push_back(0);
+	controls.back() |= static_cast<unsigned char>((length - 1) << (2 * (valueIndex % 4)));
+
+	for (int i = 0; i < length; ++i)
+		values.push_back(static_cast<unsigned char>(value >> (8 * i)));
+}
+
+// Sequential reader of the values. Each value is one 4-byte load and a mask, only the last few bytes of the
+// file are read one at a time.
+class QuantizedValueReader
+{
+public:
+	QuantizedValueReader(const unsigned char* controls, const unsigned char* values, const unsigned char* valuesEnd)
+		: _controls(controls), _pos(values), _end(valuesEnd)
+	{
+	}
+
+	bool Read(std::uint32_t& value)
 	{
-		if (line == "*")
+		static const std::uint32_t masks[4] = { 0xff, 0xffff, 0xffffff, 0xffffffff };
+
+		int code = (_controls[_index / 4] >> (2 * (_index % 4))) & 3;
+		++_index;
+
+		if (_end - _pos >= 4)
 		{
-			if (!points.empty())
-				outlines.push_back(std::move(points));
+			std::memcpy(&value, _pos, sizeof(value));
+			value &= masks[code];
 		}
 		else
 		{
-			auto strList = SplitString(line);
-			if (strList.size() == 2)
+			if (_end - _pos <= code)
+				return false;
+
+			value = 0;
+			for (int i = 0; i <= code; ++i)
+				value |= std::uint32_t(_pos[i]) << (8 * i);
+		}
+
+		_pos += code + 1;
+		return true;
+	}
+
+	bool AtEnd() const { return _pos == _end; }
+
+private:
+	const unsigned char* _controls;
+	const unsigned char* _pos;
+	const unsigned char* _end;
+	index_t _index = 0;
+};
+
+// The float spacing at the largest coordinate, so that the quantized coordinates need at most 25 bits.
+static double GetDefaultGridSize(const OutlineList& outlines)
+{
+	float maxCoord = 0.0f;
+	for (const auto& outl : outlines)
+	{
+		for (const auto& pt : outl)
+			maxCoord = std::max({ maxCoord, std::abs(pt.x), std::abs(pt.y) });
+	}
+
+	if (!(maxCoord > 0.0f) || !std::isfinite(maxCoord))
+		return 1.0;
+
+	int exponent;
+	std::frexp(maxCoord, &exponent);
+	return std::ldexp(1.0, exponent - 24);
+}
+
+static bool SaveQuantizedPolyFile(const std::string& polyFile, const OutlineList& outlines, double gridSize)
+{
+	if (gridSize <= 0.0)
+		gridSize = GetDefaultGridSize(outlines);
+
+	if (!std::isfinite(gridSize))
+		return false;
+
+	std::vector<unsigned char> counts;
+	std::vector<unsigned char> controls;
+	std::vector<unsigned char> values;
+	index_t numValues = 0;
+
+	std::int32_t firstX = 0;
+	std::int32_t firstY = 0;
+	for (const auto& outl : outlines)
+	{
+		WriteVarint(counts, outl.size());
+
+		std::int32_t prevX = firstX;
+		std::int32_t prevY = firstY;
+		for (index_t i = 0; i < outl.size(); ++i)
+		{
+			double qx = std::round(outl[i].x / gridSize);
+			double qy = std::round(outl[i].y / gridSize);
+			if (!(std::abs(qx) < QuantizedCoordLimit && std::abs(qy) < QuantizedCoordLimit))
+				return false;
+
+			std::int32_t x = static_cast<std::int32_t>(qx);
+			std::int32_t y = static_cast<std::int32_t>(qy);
+			WriteQuantizedValue(EncodeZigZag(x - prevX), numValues++, controls, values);
+			WriteQuantizedValue(EncodeZigZag(y - prevY), numValues++, controls, values);
+			prevX = x;
+			prevY = y;
+
+			if (i == 0)
+			{
+				firstX = x;
+				firstY = y;
+			}
+		}
+	}
+
+	std::ofstream file(polyFile, std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	QuantizedPolyHeader header = { };
+	std::memcpy(header.magic, QuantizedPolyMagic, sizeof(QuantizedPolyMagic));
+	header.version = QuantizedPolyVersion;
+	header.gridSize = gridSize;
+	header.numOutlines = outlines.size();
+	header.numPoints = numValues / 2;
+	header.countsSize = counts.size();
+	header.valuesSize = values.size();
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(counts.data()), counts.size());
+	file.write(reinterpret_cast<const char*>(controls.data()), controls.size());
+	file.write(reinterpret_cast<const char*>(values.data()), values.size());
+
+	return file.good();
+}
+
+static bool LoadQuantizedPolyFile(const MappedFile& file, OutlineList& outlines)
+{
+	QuantizedPolyHeader header;
+	if (file.GetSize() < sizeof(header))
+		return false;
+
+	std::memcpy(&header, file.GetData(), sizeof(header));
+	const auto* data = reinterpret_cast<const unsigned char*>(file.GetData());
+	index_t dataSize = file.GetSize() - sizeof(header);
+
+	// Each count and each point take at least one byte, larger sizes can't fit.
+	if (header.version != QuantizedPolyVersion || !(header.gridSize > 0.0) || !std::isfinite(header.gridSize) ||
+		header.numOutlines < 0 || header.numPoints < 0 || header.countsSize < 0 || header.valuesSize < 0 ||
+		header.countsSize > dataSize || header.numPoints > dataSize || header.valuesSize > dataSize ||
+		header.countsSize + (header.numPoints + 1) / 2 + header.valuesSize != dataSize)
+	{
+		return false;
+	}
+
+	const unsigned char* countPos = data + sizeof(header);
+	const unsigned char* countsEnd = countPos + header.countsSize;
+	const unsigned char* controls = countsEnd;
+	const unsigned char* values = controls + (header.numPoints + 1) / 2;
+	QuantizedValueReader reader(controls, values, values + header.valuesSize);
+
+	outlines.reserve(outlines.size() + std::min<index_t>(header.numOutlines, header.countsSize));
+
+	std::int32_t firstX = 0;
+	std::int32_t firstY = 0;
+	std::uint64_t remainingPoints = header.numPoints;
+	for (index_t o = 0; o < header.numOutlines; ++o)
+	{
+		std::uint64_t numPoints;
+		if (!ReadVarint(countPos, countsEnd, numPoints) || numPoints > remainingPoints)
+			return false;
+
+		remainingPoints -= numPoints;
+		Outline outline(numPoints);
+
+		// Unsigned sums, so that corrupt differences wrap instead of overflowing.
+		std::uint32_t x = firstX;
+		std::uint32_t y = firstY;
+		for (index_t i = 0; i < outline.size(); ++i)
+		{
+			std::uint32_t dx, dy;
+			if (!reader.Read(dx) || !reader.Read(dy))
+				return false;
+
+			x += DecodeZigZag(dx);
+			y += DecodeZigZag(dy);
+			outline[i] = {
+				static_cast<float>(static_cast<std::int32_t>(x) * header.gridSize),
+				static_cast<float>(static_cast<std::int32_t>(y) * header.gridSize) };
+
+			if (i == 0)
 			{
-				try
-				{
-					float valX = std::stof(strList[0]);
-					float valY = std::stof(strList[1]);
-					points.push_back({ valX, valY });
-				}
-				catch (...) { }
+				firstX = x;
+				firstY = y;
 			}
 		}
+
+		outlines.push_back(std::move(outline));
+	}
+
+	return remainingPoints == 0 && countPos == countsEnd && reader.AtEnd();
+}
+
+bool ListPolyFiles(const std::string& path, std::vector<std::string>& outPolyFiles)
+{
+	outPolyFiles.clear();
+
+	std::error_code ec;
+	if (!std::filesystem::is_directory(path, ec))
+	{
+		if (!std::filesystem::is_regular_file(path, ec))
+			return false;
+
+		outPolyFiles.push_back(path);
+		return true;
+	}
+
+	for (const auto& entry : std::filesystem::directory_iterator(path, ec))
+	{
+		auto extension = entry.path().extension();
+		if (entry.is_regular_file() && (extension == ".poly" || extension == ".bpoly" || extension == ".qpoly"))
+			outPolyFiles.push_back(entry.path().string());
+	}
+
+	if (ec)
+		return false;
+
+	std::sort(outPolyFiles.begin(), outPolyFiles.end());
+
+	return true;
+}
+
+// Next line of the text without the line break, a trailing '\r' is dropped as well.
+static bool NextLine(const char*& pos, const char* end, const char*& outLineBegin, const char*& outLineEnd)
+{
+	if (pos == end)
+		return false;
+
+	auto newline = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+	outLineBegin = pos;
+	outLineEnd = (newline != nullptr) ? newline : end;
+	pos = (newline != nullptr) ? newline + 1 : end;
+
+	if (outLineEnd != outLineBegin && outLineEnd[-1] == '\r')
+		--outLineEnd;
+
+	return true;
+}
+
+static bool IsOutlineSeparator(const char* lineBegin, const char* lineEnd)
+{
+	return (lineEnd - lineBegin == 1 && *lineBegin == '*');
+}
+
+static const char* SkipBlanks(const char* pos, const char* end)
+{
+	while (pos != end && (*pos == ' ' || *pos == '\t'))
+		++pos;
+
+	return pos;
+}
+
+// A line with exactly two numbers. Any other line is skipped by the loader.
+static bool ParsePoint(const char* lineBegin, const char* lineEnd, math3d::vec2f& outPoint)
+{
+	float values[2];
+	const char* pos = lineBegin;
+
+	for (float& value : values)
+	{
+		pos = SkipBlanks(pos, lineEnd);
+		if (pos != lineEnd && *pos == '+')
+			++pos;
+
+		auto result = std::from_chars(pos, lineEnd, value);
+		if (result.ec != std::errc())
+			return false;
+
+		// Like std::stof before, ignore what follows the number in the same token.
+		pos = result.ptr;
+		while (pos != lineEnd && *pos != ' ' && *pos != '\t')
+			++pos;
+	}
+
+	if (SkipBlanks(pos, lineEnd) != lineEnd)
+		return false;
+
+	outPoint = { values[0], values[1] };
+
+	return true;
+}
+
+// Parse the lines between begin and end into blocks, which are separated by the '*' lines. Blocks without
+// points are kept, so that the blocks of consecutive chunks can be joined.
+static void ParsePolyChunk(const char* begin, const char* end, std::vector<Outline>& outBlocks)
+{
+	const char* pos;
+	const char* lineBegin;
+	const char* lineEnd;
+
+	// The first pass counts the lines of each block, so that the blocks are allocated only once.
+	std::vector<index_t> numLines(1, 0);
+	pos = begin;
+	while (NextLine(pos, end, lineBegin, lineEnd))
+	{
+		if (IsOutlineSeparator(lineBegin, lineEnd))
+			numLines.push_back(0);
+		else
+			++numLines.back();
+	}
+
+	outBlocks.resize(numLines.size());
+	for (index_t b = 0; b < numLines.size(); ++b)
+		outBlocks[b].reserve(numLines[b]);
+
+	index_t blockIndex = 0;
+	pos = begin;
+	while (NextLine(pos, end, lineBegin, lineEnd))
+	{
+		if (IsOutlineSeparator(lineBegin, lineEnd))
+		{
+			++blockIndex;
+		}
+		else
+		{
+			math3d::vec2f point;
+			if (ParsePoint(lineBegin, lineEnd, point))
+				outBlocks[blockIndex].push_back(point);
+		}
+	}
+}
+
+bool LoadPolyFile(const std::string& polyFile, OutlineList& outlines, int_t numThreads)
+{
+	// Smaller chunks don't pay for starting a thread.
+	const index_t minChunkSize = index_t(4) << 20;
+
+	MappedFile file;
+	if (!file.Open(polyFile))
+		return false;
+
+	if (file.GetSize() >= sizeof(BinaryPolyFile::Magic) && std::memcmp(file.GetData(), BinaryPolyFile::Magic, sizeof(BinaryPolyFile::Magic)) == 0)
+	{
+		file.Close();
+		BinaryPolyFile binaryFile;
+		if (!binaryFile.Open(polyFile))
+			return false;
+
+		binaryFile.GetOutlines(outlines);
+		return true;
+	}
+
+	if (file.GetSize() >= sizeof(QuantizedPolyMagic) && std::memcmp(file.GetData(), QuantizedPolyMagic, sizeof(QuantizedPolyMagic)) == 0)
+		return LoadQuantizedPolyFile(file, outlines);
+
+	const char* begin = file.GetData();
+	const char* end = begin + file.GetSize();
+
+	if (numThreads <= 0)
+		numThreads = std::max<int_t>(std::thread::hardware_concurrency(), 1);
+
+	index_t numChunks = std::max<index_t>(std::min<index_t>(numThreads, file.GetSize() / minChunkSize), 1);
+
+	// Each chunk ends after a line break, so that no line is split. A chunk can end up empty.
+	std::vector<const char*> chunkEnds(numChunks);
+	for (index_t c = 0; c < numChunks; ++c)
+	{
+		const char* chunkEnd = (c + 1 < numChunks) ? begin + file.GetSize() / numChunks * (c + 1) : end;
+		if (c > 0)
+			chunkEnd = std::max(chunkEnd, chunkEnds[c - 1]);
+
+		auto newline = (chunkEnd == end) ? nullptr : static_cast<const char*>(std::memchr(chunkEnd, '\n', end - chunkEnd));
+		chunkEnds[c] = (newline == nullptr) ? end : newline + 1;
+	}
+
+	std::vector<std::vector<Outline>> chunkBlocks(numChunks);
+	std::vector<std::thread> threads;
+	for (index_t c = 1; c < numChunks; ++c)
+		threads.emplace_back(ParsePolyChunk, chunkEnds[c - 1], chunkEnds[c], std::ref(chunkBlocks[c]));
+
+	ParsePolyChunk(begin, chunkEnds[0], chunkBlocks[0]);
+
+	for (auto& thread : threads)
+		thread.join();
+
+	// The first block of a chunk continues the last block of the previous one, the other blocks follow a separator.
+	Outline points;
+	for (index_t c = 0; c < numChunks; ++c)
+	{
+		for (index_t b = 0; b < chunkBlocks[c].size(); ++b)
+		{
+			auto& block = chunkBlocks[c][b];
+
+			if (b > 0 && !points.empty())
+				outlines.push_back(std::move(points));
+
+			if (b > 0 || points.empty())
+				points = std::move(block);
+			else
+				points.insert(points.end(), block.begin(), block.end());
+		}
 	}
 
 	if (!points.empty())
@@ -39,53 +504,178 @@ bool LoadPolyFile(const std::string& polyFile, OutlineList& outlines)
 	return true;
 }
 
-bool SavePolyFile(const std::string& polyFile, const OutlineList& outlines)
+bool LoadPolyFile(const std::string& polyFile, const math3d::vec2f& rectMin, const math3d::vec2f& rectMax, OutlineList& outlines)
 {
+	if (BinaryPolyFile::IsBinaryPolyFile(polyFile))
+	{
+		// Only the index and the selected outlines are read, so no read-ahead.
+		BinaryPolyFile binaryFile;
+		if (!binaryFile.Open(polyFile, MappedFile::Access::Random))
+			return false;
+
+		IndexList outlineIndices;
+		binaryFile.FindOutlines({ rectMin, rectMax }, outlineIndices);
+		binaryFile.GetOutlines(outlineIndices, outlines);
+		return true;
+	}
+
+	OutlineList allOutlines;
+	if (!LoadPolyFile(polyFile, allOutlines))
+		return false;
+
+	for (auto& outl : allOutlines)
+	{
+		if (outl.empty())
+			continue;
+
+		math3d::vec2f boxMin = outl[0];
+		math3d::vec2f boxMax = outl[0];
+		for (const auto& pt : outl)
+		{
+			boxMin = { std::min(boxMin.x, pt.x), std::min(boxMin.y, pt.y) };
+			boxMax = { std::max(boxMax.x, pt.x), std::max(boxMax.y, pt.y) };
+		}
+
+		if (boxMin.x <= rectMax.x && rectMin.x <= boxMax.x && boxMin.y <= rectMax.y && rectMin.y <= boxMax.y)
+			outlines.push_back(std::move(outl));
+	}
+
+	return true;
+}
+
+bool SavePolyFile(const std::string& polyFile, const OutlineList& outlines, double gridSize)
+{
+	if (std::filesystem::path(polyFile).extension() == ".bpoly")
+		return BinaryPolyFile::Save(polyFile, outlines);
+
+	if (std::filesystem::path(polyFile).extension() == ".qpoly")
+		return SaveQuantizedPolyFile(polyFile, outlines, gridSize);
+
 	std::ofstream file(polyFile);
 	if (!file.is_open())
 		return false;
 
+	BufferedWriter writer(file);
 	for (index_t i = 0; i < outlines.size(); ++i)
 	{
 		if (i > 0)
-			file << "*\n";
+			writer.Write("*\n");
 
-		auto& outl = outlines[i];
-		for (auto& pt : outl)
+		// Shortest form that reads back as the same float.
+		for (auto& pt : outlines[i])
 		{
-			file << pt.x << " " << pt.y << "\n";
+			writer.Write(pt.x);
+			writer.Write(' ');
+			writer.Write(pt.y);
+			writer.Write('\n');
 		}
 	}
 
-	return true;
+	return writer.Flush();
 }
 
 bool SaveTriangleIndices(const std::string& triangleFile, const IndexList& indices)
 {
-	std::ofstream file(triangleFile);
+	bool binary = (std::filesystem::path(triangleFile).extension() == ".btind");
+	std::ofstream file(triangleFile, binary ? std::ios::binary : std::ios::out);
 	if (!file.is_open())
 		return false;
 
+	if (binary)
+		return WriteBinaryArray(file, BinaryIndicesMagic, indices.data(), indices.size());
+
+	BufferedWriter writer(file);
 	for (index_t i = 0; i < indices.size(); i += 3)
 	{
-		file << indices[i] << " " << indices[i + 1] << " " << indices[i + 2] << "\n";
+		writer.Write(indices[i]);
+		writer.Write(' ');
+		writer.Write(indices[i + 1]);
+		writer.Write(' ');
+		writer.Write(indices[i + 2]);
+		writer.Write('\n');
 	}
 
-	return true;
+	return writer.Flush();
 }
 
-bool SaveTrianglePoints(const std::string& triangleFile, const IndexList& indices, const std::vector<math3d::vec2f>& pointCoords)
+bool SaveTrianglePoints(const std::string& triangleFile, const IndexList& indices, const CoordArray& pointCoords)
 {
-	std::ofstream file(triangleFile);
+	bool binary = (std::filesystem::path(triangleFile).extension() == ".btpts");
+	std::ofstream file(triangleFile, binary ? std::ios::binary : std::ios::out);
 	if (!file.is_open())
 		return false;
 
+	if (binary)
+		return WriteBinaryArray(file, BinaryPointsMagic, pointCoords.data(), pointCoords.size());
+
+	BufferedWriter writer(file);
 	for (index_t i = 0; i < indices.size(); i += 3)
 	{
-		file << "[" << pointCoords[indices[i]].x << " " << pointCoords[indices[i]].y << "] "
-			<< "[" << pointCoords[indices[i + 1]].x << " " << pointCoords[indices[i + 1]].y << "] "
-			<< "[" << pointCoords[indices[i + 2]].x << " " << pointCoords[indices[i + 2]].y << "]\n";
+		for (index_t v = 0; v < 3; ++v)
+		{
+			const auto& pt = pointCoords[indices[i + v]];
+			writer.Write('[');
+			writer.Write(pt.x);
+			writer.Write(' ');
+			writer.Write(pt.y);
+			writer.Write((v < 2) ? "] " : "]\n");
+		}
 	}
 
-	return true;
+	return writer.Flush();
+}
+
+std::string EscapeJSON(const std::string& str)
+{
+	const char hexDigits[] = "0123456789abcdef";
+
+	std::string escaped;
+	for (char c : str)
+	{
+		switch (c)
+		{
+		case '"':
+			escaped += "\\\"";
+			break;
+		case '\\':
+			escaped += "\\\\";
+			break;
+		case '\n':
+			escaped += "\\n";
+			break;
+		case '\r':
+			escaped += "\\r";
+			break;
+		case '\t':
+			escaped += "\\t";
+			break;
+		default:
+			// Other control characters aren't allowed in strings either.
+			if (static_cast<unsigned char>(c) < 0x20)
+			{
+				escaped += "\\u00";
+				escaped += hexDigits[c >> 4];
+				escaped += hexDigits[c & 0xf];
+			}
+			else
+				escaped += c;
+			break;
+		}
+	}
+
+	return escaped;
+}
+
+std::string QuoteCSV(const std::string& str)
+{
+	std::string quoted = "\"";
+	for (char c : str)
+	{
+		if (c == '"')
+			quoted += '"';
+		quoted += c;
+	}
+	quoted += '"';
+
+	return quoted;
 }
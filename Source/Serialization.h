@@ -4,9 +4,27 @@
 #include <string>
 #include "SeidelTriangulator.h"
 
-bool LoadPolyFile(const std::string& polyFile, OutlineList& outlines);
-bool SavePolyFile(const std::string& polyFile, const OutlineList& outlines);
+// A single file is returned as is, a directory yields its .poly, .bpoly and .qpoly files in sorted order.
+bool ListPolyFiles(const std::string& path, std::vector<std::string>& outPolyFiles);
+// Binary .bpoly files are recognized by their header, see BinaryPolyFile, and so are quantized .qpoly files. Large text files are parsed
+// in chunks on up to numThreads threads, 0 uses all hardware threads.
+// The outlines are appended in file order.
+bool LoadPolyFile(const std::string& polyFile, OutlineList& outlines, int_t numThreads = 0);
+// Only the outlines whose bounding boxes intersect the rectangle, in file order. Indexed .bpoly files read just
+// these outlines, other files are loaded completely and filtered.
+bool LoadPolyFile(const std::string& polyFile, const math3d::vec2f& rectMin, const math3d::vec2f& rectMax, OutlineList& outlines);
+// Written in the binary format if the file name has the .bpoly extension. The .qpoly extension selects the quantized
+// format, which rounds the coordinates to multiples of gridSize and stores the differences between consecutive points
+// as varints. A gridSize of 0 uses the float spacing at the largest coordinate. Rounding can merge close points.
+bool SavePolyFile(const std::string& polyFile, const OutlineList& outlines, double gridSize = 0.0);
+// The .btind and .btpts extensions select the binary variants: a 16-byte header, "BTIN" or "BTPT", uint16 version,
+// uint16 element size and int64 count, followed by the raw index array or the raw point coordinate array.
+// The binary points are the polygon points the indices refer to, the text points are the corners of each triangle.
 bool SaveTriangleIndices(const std::string& triangleFile, const IndexList& indices);
-bool SaveTrianglePoints(const std::string& triangleFile, const IndexList& indices, const std::vector<math3d::vec2f>& pointCoords);
+bool SaveTrianglePoints(const std::string& triangleFile, const IndexList& indices, const CoordArray& pointCoords);
+
+// For the reports: the contents of a JSON string, without the quotes, and a quoted CSV field.
+std::string EscapeJSON(const std::string& str);
+std::string QuoteCSV(const std::string& str);
 
 #endif // _SERIALIZATION_H_
@@ -0,0 +1,492 @@
+#include "SweepTriangulator.h"
+#include <cassert>
+#include <algorithm>
+#include <numeric>
+
+
+SweepTriangulator::SweepTriangulator(const OutlineList& outlines)
+{
+	InitPolygon(outlines);
+
+	ScopedPhase phase(Phase::Init);
+	OnPolygonEdited();
+}
+
+SweepTriangulator::SweepTriangulator(const math3d::vec2f* pointCoords, const index_t* outlineOffsets, index_t numOutlines)
+{
+	InitPolygon(pointCoords, outlineOffsets, numOutlines);
+
+	ScopedPhase phase(Phase::Init);
+	OnPolygonEdited();
+}
+
+void SweepTriangulator::OnPolygonEdited()
+{
+	// Segment i starts in point i, so the segment ending in a point is the one whose other point it is.
+	_prevSegment.resize(_pointCoords.size());
+	for (index_t i = 0; i < _segments.size(); ++i)
+	{
+		const auto& seg = _segments[i];
+		index_t endPtIndex = (seg.upperPointIndex == i) ? seg.lowerPointIndex : seg.upperPointIndex;
+		_prevSegment[endPtIndex] = i;
+	}
+}
+
+bool SweepTriangulator::Triangulate(FillRule fillRule, Winding winding, IndexList& outTriangleIndices)
+{
+	return Triangulate(fillRule, winding, outTriangleIndices, nullptr);
+}
+
+bool SweepTriangulator::Triangulate(FillRule fillRule, Winding winding, TriangleSink& sink)
+{
+	// Holds the triangles of one piece at a time.
+	IndexList triangleIndices;
+
+	return Triangulate(fillRule, winding, triangleIndices, &sink);
+}
+
+bool SweepTriangulator::Triangulate(FillRule fillRule, Winding winding, IndexList& outTriangleIndices, TriangleSink* sink)
+{
+	outTriangleIndices.clear();
+
+	if (!_isSimplePolygon)
+		return false;
+
+	{
+		ScopedPhase phase(Phase::MonotonePartition);
+		PartitionIntoMonotone(fillRule);
+	}
+
+	ScopedPhase phase(Phase::Triangulation);
+	TriangulateMonotonePieces(fillRule, winding, outTriangleIndices, sink);
+
+	return true;
+}
+
+bool SweepTriangulator::SegmentOrder::operator()(index_t segIndex1, index_t segIndex2) const
+{
+	if (segIndex1 == segIndex2)
+		return false;
+
+	// Comparing against the event point.
+	if (segIndex1 < 0)
+		return triangulator->IsLeftOfSegment(triangulator->_eventPoint, segIndex2);
+	if (segIndex2 < 0)
+		return !triangulator->IsLeftOfSegment(triangulator->_eventPoint, segIndex1);
+
+	const auto& coords = triangulator->_pointCoords;
+	const auto& seg1 = triangulator->_segments[segIndex1];
+	const auto& seg2 = triangulator->_segments[segIndex2];
+
+	// Segments starting in the same point are ordered by their lower points.
+	if (seg1.upperPointIndex == seg2.upperPointIndex)
+		return triangulator->IsLeftOfSegment(coords[seg1.lowerPointIndex], segIndex2);
+
+	// Segments don't intersect, so it is enough to test the upper point of the segment
+	// that starts lower against the other segment.
+	if (PointsVerticalRelation(coords[seg2.upperPointIndex], coords[seg1.upperPointIndex]) == VerticalRelation::Below)
+		return !triangulator->IsLeftOfSegment(coords[seg2.upperPointIndex], segIndex1);
+	else
+		return triangulator->IsLeftOfSegment(coords[seg1.upperPointIndex], segIndex2);
+}
+
+void SweepTriangulator::PartitionIntoMonotone(FillRule fillRule)
+{
+	SweepStatus status(SegmentOrder { this });
+	_segmentStates.assign(_segments.size(), SegmentState { });
+	_diagonals.clear();
+
+	// Sort the points from top to bottom.
+	_events.resize(_pointCoords.size());
+	std::iota(_events.begin(), _events.end(), 0);
+	std::sort(_events.begin(), _events.end(), [this](index_t ptIndex1, index_t ptIndex2) {
+		return PointsVerticalRelation(_pointCoords[ptIndex1], _pointCoords[ptIndex2]) == VerticalRelation::Above;
+	});
+
+	// Every segment is stored in the sweep status together with the winding number of the region to its right
+	// and the helper point of that region. Since regions are only classified by the fill rule, a point can be,
+	// for example, a split point of the outer region and a start point of the inner region at the same time.
+	for (index_t ptIndex : _events)
+	{
+		index_t prevSegIndex = _prevSegment[ptIndex];
+		index_t nextSegIndex = ptIndex;
+		bool prevBelow = (_segments[prevSegIndex].upperPointIndex == ptIndex);
+		bool nextBelow = (_segments[nextSegIndex].upperPointIndex == ptIndex);
+		_eventPoint = _pointCoords[ptIndex];
+
+		if (prevBelow && nextBelow)
+		{
+			// Start or split point. Both segments begin here.
+			auto pos = status.lower_bound(-1);
+			index_t outerSegIndex = (pos != status.begin()) ? *std::prev(pos) : -1;
+			int_t windingLeft = (outerSegIndex >= 0) ? _segmentStates[outerSegIndex].windingRight : 0;
+
+			if (IsInside(fillRule, windingLeft))
+			{
+				// Split point of the region around the point. Connect it to the helper of that region.
+				auto& outerState = _segmentStates[outerSegIndex];
+				_diagonals.emplace_back(ptIndex, outerState.helperPointIndex);
+				outerState.helperPointIndex = ptIndex;
+				outerState.helperIsMerge = false;
+			}
+
+			auto prevPos = status.insert(prevSegIndex).first;
+			auto nextPos = status.insert(nextSegIndex).first;
+			bool prevIsLeft = (std::next(prevPos) == nextPos);
+			auto& leftState = _segmentStates[prevIsLeft ? prevSegIndex : nextSegIndex];
+			auto& rightState = _segmentStates[prevIsLeft ? nextSegIndex : prevSegIndex];
+
+			leftState.statusPos = prevIsLeft ? prevPos : nextPos;
+			leftState.windingRight = windingLeft + CrossingDirection(_segments[*leftState.statusPos]);
+			leftState.helperPointIndex = ptIndex;
+			leftState.helperIsMerge = false;
+
+			rightState.statusPos = prevIsLeft ? nextPos : prevPos;
+			rightState.windingRight = leftState.windingRight + CrossingDirection(_segments[*rightState.statusPos]);
+			rightState.helperPointIndex = ptIndex;
+			rightState.helperIsMerge = false;
+		}
+		else if (!prevBelow && !nextBelow)
+		{
+			// End or merge point. Both segments end here.
+			auto prevPos = _segmentStates[prevSegIndex].statusPos;
+			auto nextPos = _segmentStates[nextSegIndex].statusPos;
+			bool prevIsLeft = (std::next(prevPos) == nextPos);
+			auto leftPos = prevIsLeft ? prevPos : nextPos;
+			auto& leftState = _segmentStates[prevIsLeft ? prevSegIndex : nextSegIndex];
+			auto& rightState = _segmentStates[prevIsLeft ? nextSegIndex : prevSegIndex];
+			index_t outerSegIndex = (leftPos != status.begin()) ? *std::prev(leftPos) : -1;
+			int_t windingLeft = (outerSegIndex >= 0) ? _segmentStates[outerSegIndex].windingRight : 0;
+
+			// End point of the region between the two segments.
+			if (IsInside(fillRule, leftState.windingRight) && leftState.helperIsMerge)
+				_diagonals.emplace_back(ptIndex, leftState.helperPointIndex);
+
+			if (IsInside(fillRule, windingLeft))
+			{
+				// Merge point of the regions on the left and on the right.
+				if (rightState.helperIsMerge)
+					_diagonals.emplace_back(ptIndex, rightState.helperPointIndex);
+
+				auto& outerState = _segmentStates[outerSegIndex];
+				if (outerState.helperIsMerge)
+					_diagonals.emplace_back(ptIndex, outerState.helperPointIndex);
+
+				outerState.helperPointIndex = ptIndex;
+				outerState.helperIsMerge = true;
+			}
+
+			status.erase(prevPos);
+			status.erase(nextPos);
+		}
+		else
+		{
+			// Regular point. The upper segment is replaced by the lower one in the sweep status.
+			index_t upperSegIndex = prevBelow ? nextSegIndex : prevSegIndex;
+			index_t lowerSegIndex = prevBelow ? prevSegIndex : nextSegIndex;
+			auto& upperState = _segmentStates[upperSegIndex];
+			auto& lowerState = _segmentStates[lowerSegIndex];
+			auto pos = upperState.statusPos;
+			index_t outerSegIndex = (pos != status.begin()) ? *std::prev(pos) : -1;
+			int_t windingLeft = (outerSegIndex >= 0) ? _segmentStates[outerSegIndex].windingRight : 0;
+
+			// The region on the right is bounded by the segments on the left.
+			if (IsInside(fillRule, upperState.windingRight) && upperState.helperIsMerge)
+				_diagonals.emplace_back(ptIndex, upperState.helperPointIndex);
+
+			pos = status.erase(pos);
+			lowerState.statusPos = status.insert(pos, lowerSegIndex);
+			lowerState.windingRight = upperState.windingRight;
+			lowerState.helperPointIndex = ptIndex;
+			lowerState.helperIsMerge = false;
+
+			// The region on the left is bounded by the segments on the right.
+			if (IsInside(fillRule, windingLeft))
+			{
+				auto& outerState = _segmentStates[outerSegIndex];
+				if (outerState.helperIsMerge)
+					_diagonals.emplace_back(ptIndex, outerState.helperPointIndex);
+
+				outerState.helperPointIndex = ptIndex;
+				outerState.helperIsMerge = false;
+			}
+		}
+	}
+
+	assert(status.empty());
+}
+
+// With a sink, the triangles of each piece are passed to it and removed from the output list.
+void SweepTriangulator::TriangulateMonotonePieces(FillRule fillRule, Winding winding, IndexList& outTriangleIndices, TriangleSink* sink)
+{
+	// Build a half-edge structure out of the segments and the diagonals. Each half-edge has its region on the left,
+	// so for a segment directed downwards, that is the region to the right of the segment.
+	_halfEdges.clear();
+	for (index_t i = 0; i < _segments.size(); ++i)
+	{
+		const auto& seg = _segments[i];
+		int_t windingRight = _segmentStates[i].windingRight;
+		int_t windingLeft = windingRight - CrossingDirection(seg);
+		AddHalfEdgePair(seg.upperPointIndex, seg.lowerPointIndex, IsInside(fillRule, windingRight), IsInside(fillRule, windingLeft));
+	}
+
+	for (const auto& diag : _diagonals)
+		AddHalfEdgePair(diag.first, diag.second, true, true);
+
+	// Sort outgoing half-edges of each point counter-clockwise.
+	_outgoingOffsets.assign(_pointCoords.size() + 1, 0);
+	for (const auto& he : _halfEdges)
+		++_outgoingOffsets[he.originIndex + 1];
+	std::partial_sum(_outgoingOffsets.begin(), _outgoingOffsets.end(), _outgoingOffsets.begin());
+
+	_outgoing.resize(_halfEdges.size());
+	for (index_t i = 0; i < _halfEdges.size(); ++i)
+		_outgoing[_outgoingOffsets[_halfEdges[i].originIndex]++] = i;
+	std::rotate(_outgoingOffsets.rbegin(), _outgoingOffsets.rbegin() + 1, _outgoingOffsets.rend());
+	_outgoingOffsets[0] = 0;
+
+	auto angleLess = [this](index_t heIndex1, index_t heIndex2) -> bool {
+		const auto& he1 = _halfEdges[heIndex1];
+		const auto& he2 = _halfEdges[heIndex2];
+		const auto& org1 = _pointCoords[he1.originIndex];
+		const auto& org2 = _pointCoords[he2.originIndex];
+		const auto& dst1 = _pointCoords[_halfEdges[he1.twinIndex].originIndex];
+		const auto& dst2 = _pointCoords[_halfEdges[he2.twinIndex].originIndex];
+		double dx1 = double(dst1.x) - org1.x;
+		double dy1 = double(dst1.y) - org1.y;
+		double dx2 = double(dst2.x) - org2.x;
+		double dy2 = double(dst2.y) - org2.y;
+		bool upper1 = dy1 > 0.0 || (dy1 == 0.0 && dx1 > 0.0);
+		bool upper2 = dy2 > 0.0 || (dy2 == 0.0 && dx2 > 0.0);
+
+		if (upper1 != upper2)
+			return upper1;
+
+		return dx1 * dy2 - dy1 * dx2 > 0.0;
+	};
+
+	for (index_t i = 0; i < _pointCoords.size(); ++i)
+	{
+		auto first = _outgoing.begin() + _outgoingOffsets[i];
+		auto last = _outgoing.begin() + _outgoingOffsets[i + 1];
+		if (last - first > 2)
+			std::sort(first, last, angleLess);
+
+		for (auto it = first; it != last; ++it)
+			_halfEdges[*it].slot = it - _outgoing.begin();
+	}
+
+	// Walk around each inside region. The next half-edge of a region is the one that comes right before
+	// the twin of the current half-edge in the counter-clockwise order around their shared point.
+	for (index_t startIndex = 0; startIndex < _halfEdges.size(); ++startIndex)
+	{
+		if (!_halfEdges[startIndex].inside || _halfEdges[startIndex].visited)
+			continue;
+
+		_piece.clear();
+		index_t heIndex = startIndex;
+
+		do
+		{
+			auto& he = _halfEdges[heIndex];
+			he.visited = true;
+			_piece.push_back(he.originIndex);
+
+			const auto& twin = _halfEdges[he.twinIndex];
+			index_t ptIndex = twin.originIndex;
+			index_t slot = (twin.slot == _outgoingOffsets[ptIndex]) ? _outgoingOffsets[ptIndex + 1] - 1 : twin.slot - 1;
+			heIndex = _outgoing[slot];
+		}
+		while (heIndex != startIndex && _piece.size() <= _halfEdges.size());
+
+		assert(heIndex == startIndex);
+		TriangulateMonotonePiece(winding, outTriangleIndices);
+
+		if (sink != nullptr && !outTriangleIndices.empty())
+		{
+			sink->AddTriangles(outTriangleIndices.data(), outTriangleIndices.size());
+			outTriangleIndices.clear();
+		}
+	}
+}
+
+// Triangulate the y-monotone polygon stored in _piece in counter-clockwise order.
+void SweepTriangulator::TriangulateMonotonePiece(Winding winding, IndexList& outTriangleIndices)
+{
+	index_t n = _piece.size();
+	if (n < 3)
+		return;
+
+	auto isAbove = [this](index_t ptIndex1, index_t ptIndex2) {
+		return PointsVerticalRelation(_pointCoords[ptIndex1], _pointCoords[ptIndex2]) == VerticalRelation::Above;
+	};
+
+	auto orientation = [this](index_t ptIndex1, index_t ptIndex2, index_t ptIndex3) {
+		const auto& a = _pointCoords[ptIndex1];
+		const auto& b = _pointCoords[ptIndex2];
+		const auto& c = _pointCoords[ptIndex3];
+		return (double(b.x) - a.x) * (double(c.y) - a.y) - (double(b.y) - a.y) * (double(c.x) - a.x);
+	};
+
+	index_t top = 0;
+	index_t bottom = 0;
+	for (index_t i = 1; i < n; ++i)
+	{
+		if (isAbove(_piece[i], _piece[top]))
+			top = i;
+		if (isAbove(_piece[bottom], _piece[i]))
+			bottom = i;
+	}
+
+	// Merge the two chains into one list sorted from top to bottom. Going counter-clockwise
+	// from the top point leads down the left chain.
+	_sortedPiece.clear();
+	_sortedPiece.emplace_back(_piece[top], Chain::Left);
+	index_t left = (top + 1) % n;
+	index_t right = (top + n - 1) % n;
+
+	while (left != bottom || right != bottom)
+	{
+		if (left != bottom && (right == bottom || isAbove(_piece[left], _piece[right])))
+		{
+			_sortedPiece.emplace_back(_piece[left], Chain::Left);
+			left = (left + 1) % n;
+		}
+		else
+		{
+			_sortedPiece.emplace_back(_piece[right], Chain::Right);
+			right = (right + n - 1) % n;
+		}
+	}
+
+	_sortedPiece.emplace_back(_piece[bottom], Chain::Right);
+
+	_stack.clear();
+	_stack.push_back(_sortedPiece[0]);
+	_stack.push_back(_sortedPiece[1]);
+
+	for (index_t j = 2; j < n - 1; ++j)
+	{
+		index_t ptIndex = _sortedPiece[j].first;
+		Chain chain = _sortedPiece[j].second;
+
+		if (chain != _stack.back().second)
+		{
+			// The point is on the opposite chain; all points on the stack can be connected to it.
+			while (_stack.size() > 1)
+			{
+				index_t lower = _stack.back().first;
+				_stack.pop_back();
+				index_t upper = _stack.back().first;
+
+				if (chain == Chain::Left)
+					AddTriangle(winding, ptIndex, lower, upper, outTriangleIndices);
+				else
+					AddTriangle(winding, ptIndex, upper, lower, outTriangleIndices);
+			}
+
+			_stack.clear();
+			_stack.push_back(_sortedPiece[j - 1]);
+			_stack.push_back(_sortedPiece[j]);
+		}
+		else
+		{
+			// The point is on the same chain; cut off triangles while the diagonals are inside the polygon.
+			auto last = _stack.back();
+			_stack.pop_back();
+
+			while (!_stack.empty())
+			{
+				index_t upper = _stack.back().first;
+
+				if (chain == Chain::Left)
+				{
+					if (orientation(upper, last.first, ptIndex) <= 0.0)
+						break;
+					AddTriangle(winding, upper, last.first, ptIndex, outTriangleIndices);
+				}
+				else
+				{
+					if (orientation(ptIndex, last.first, upper) <= 0.0)
+						break;
+					AddTriangle(winding, ptIndex, last.first, upper, outTriangleIndices);
+				}
+
+				last = _stack.back();
+				_stack.pop_back();
+			}
+
+			_stack.push_back(last);
+			_stack.push_back(_sortedPiece[j]);
+		}
+	}
+
+	// Connect the bottom point to the rest of the stack.
+	index_t bottomIndex = _sortedPiece[n - 1].first;
+	while (_stack.size() > 1)
+	{
+		auto lower = _stack.back();
+		_stack.pop_back();
+		index_t upper = _stack.back().first;
+
+		if (lower.second == Chain::Left)
+			AddTriangle(winding, upper, lower.first, bottomIndex, outTriangleIndices);
+		else
+			AddTriangle(winding, bottomIndex, lower.first, upper, outTriangleIndices);
+	}
+}
+
+void SweepTriangulator::AddHalfEdgePair(index_t pointIndex1, index_t pointIndex2, bool inside1, bool inside2)
+{
+	index_t heIndex = _halfEdges.size();
+	_halfEdges.push_back({ pointIndex1, heIndex + 1, -1, inside1, false });
+	_halfEdges.push_back({ pointIndex2, heIndex, -1, inside2, false });
+}
+
+bool SweepTriangulator::IsLeftOfSegment(const math3d::vec2f& point, index_t segIndex) const
+{
+	// For a segment directed downwards, the left side is on the right of the direction vector.
+	const auto& seg = _segments[segIndex];
+	const auto& upper = _pointCoords[seg.upperPointIndex];
+	const auto& lower = _pointCoords[seg.lowerPointIndex];
+	double cross =
+		(double(lower.x) - upper.x) * (double(point.y) - upper.y) -
+		(double(lower.y) - upper.y) * (double(point.x) - upper.x);
+
+	return cross < 0.0;
+}
+
+bool SweepTriangulator::IsInside(FillRule fillRule, int_t winding)
+{
+	switch (fillRule)
+	{
+	case FillRule::NonZero:
+		return winding != 0;
+	case FillRule::EvenOdd:
+		return (winding & 1) == 1;
+	}
+
+	return false;
+}
+
+int_t SweepTriangulator::CrossingDirection(const Segment& segment)
+{
+	// Same convention as the segment crossing counter of the Seidel triangulator.
+	return segment.upward ? -1 : 1;
+}
+
+void SweepTriangulator::AddTriangle(Winding winding, index_t ccwIndex1, index_t ccwIndex2, index_t ccwIndex3, IndexList& outTriangleIndices)
+{
+	if (winding == Winding::CCW)
+	{
+		outTriangleIndices.push_back(ccwIndex1);
+		outTriangleIndices.push_back(ccwIndex2);
+		outTriangleIndices.push_back(ccwIndex3);
+	}
+	else
+	{
+		outTriangleIndices.push_back(ccwIndex3);
+		outTriangleIndices.push_back(ccwIndex2);
+		outTriangleIndices.push_back(ccwIndex1);
+	}
+}
@@ -0,0 +1,86 @@
+#ifndef _SWEEP_TRIANGULATOR_H_
+#define _SWEEP_TRIANGULATOR_H_
+
+#include <vector>
+#include <set>
+#include <utility>
+#include "Triangulator.h"
+
+
+// Deterministic O(n log n) triangulator. A plane sweep from top to bottom partitions the polygon
+// into y-monotone pieces by adding diagonals at split and merge vertices, then each piece
+// is triangulated in linear time.
+class SweepTriangulator : public Triangulator
+{
+public:
+	SweepTriangulator(const OutlineList& outlines);
+	// Uses the coordinates in place, they must outlive the triangulator.
+	SweepTriangulator(const math3d::vec2f* pointCoords, const index_t* outlineOffsets, index_t numOutlines);
+
+	bool Triangulate(FillRule fillRule, Winding winding, IndexList& outTriangleIndices) override;
+	bool Triangulate(FillRule fillRule, Winding winding, TriangleSink& sink) override;
+
+private:
+	// Orders the segments crossed by the sweep line from left to right.
+	// Segment index -1 stands for the current event point.
+	struct SegmentOrder
+	{
+		bool operator()(index_t segIndex1, index_t segIndex2) const;
+
+		const SweepTriangulator* triangulator;
+	};
+
+	using SweepStatus = std::set<index_t, SegmentOrder>;
+
+	struct SegmentState
+	{
+		SweepStatus::iterator statusPos;
+		int_t windingRight = 0;	// Winding number of the region to the right of the segment.
+		index_t helperPointIndex = -1;
+		bool helperIsMerge = false;
+	};
+
+	struct HalfEdge
+	{
+		index_t originIndex;
+		index_t twinIndex;
+		index_t slot;			// Position in the origin point's list of outgoing half-edges.
+		bool inside;			// The region on the left side of the half-edge is inside the polygon.
+		bool visited;
+	};
+
+	enum class Chain
+	{
+		Left,
+		Right
+	};
+
+	void OnPolygonEdited() override;
+
+	void PartitionIntoMonotone(FillRule fillRule);
+	bool Triangulate(FillRule fillRule, Winding winding, IndexList& outTriangleIndices, TriangleSink* sink);
+	void TriangulateMonotonePieces(FillRule fillRule, Winding winding, IndexList& outTriangleIndices, TriangleSink* sink);
+	void TriangulateMonotonePiece(Winding winding, IndexList& outTriangleIndices);
+	void AddHalfEdgePair(index_t pointIndex1, index_t pointIndex2, bool inside1, bool inside2);
+	bool IsLeftOfSegment(const math3d::vec2f& point, index_t segIndex) const;
+
+	static bool IsInside(FillRule fillRule, int_t winding);
+	static int_t CrossingDirection(const Segment& segment);
+	static void AddTriangle(Winding winding, index_t ccwIndex1, index_t ccwIndex2, index_t ccwIndex3, IndexList& outTriangleIndices);
+
+	std::vector<index_t> _prevSegment;	// For each point, the index of the segment that ends in it.
+	std::vector<SegmentState> _segmentStates;
+	std::vector<std::pair<index_t, index_t>> _diagonals;
+	math3d::vec2f _eventPoint;
+
+	// Buffers reused between runs.
+	std::vector<index_t> _events;
+	std::vector<HalfEdge> _halfEdges;
+	std::vector<index_t> _outgoingOffsets;
+	std::vector<index_t> _outgoing;
+	IndexList _piece;
+	std::vector<std::pair<index_t, Chain>> _sortedPiece;
+	std::vector<std::pair<index_t, Chain>> _stack;
+};
+
+#endif // _SWEEP_TRIANGULATOR_H_
@@ -0,0 +1,83 @@
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <fstream>
+
+TraceRecorder::TraceRecorder(index_t threadId, bool recordDetails)
+	: _threadId(threadId), _recordDetails(recordDetails)
+{
+}
+
+void TraceRecorder::OnPhaseBegin(Triangulator::Phase phase)
+{
+	AddEvent(Triangulator::GetPhaseName(phase), "phase", -1, 'B');
+}
+
+void TraceRecorder::OnPhaseEnd(Triangulator::Phase phase)
+{
+	AddEvent(Triangulator::GetPhaseName(phase), "phase", -1, 'E');
+}
+
+void TraceRecorder::OnDetailBegin(const char* name, index_t index)
+{
+	AddEvent(name, "detail", index, 'B');
+}
+
+void TraceRecorder::OnDetailEnd(const char* name, index_t index)
+{
+	AddEvent(name, "detail", index, 'E');
+}
+
+void TraceRecorder::Begin(const char* name, index_t index)
+{
+	AddEvent(name, "run", index, 'B');
+}
+
+void TraceRecorder::End(const char* name, index_t index)
+{
+	AddEvent(name, "run", index, 'E');
+}
+
+void TraceRecorder::AddEvent(const char* name, const char* category, index_t index, char type)
+{
+	_events.push_back({ name, category, index, type, std::chrono::steady_clock::now() });
+}
+
+bool TraceRecorder::SaveJSON(const std::string& fileName, const std::vector<const TraceRecorder*>& recorders)
+{
+	std::ofstream file(fileName);
+	if (!file.is_open())
+		return false;
+
+	auto startTime = std::chrono::steady_clock::time_point::max();
+	for (auto recorder : recorders)
+	{
+		if (!recorder->_events.empty())
+			startTime = std::min(startTime, recorder->_events.front().time);
+	}
+
+	file.precision(12);
+	file << "{\n\"displayTimeUnit\": \"ms\",\n\"traceEvents\": [";
+
+	bool first = true;
+	for (auto recorder : recorders)
+	{
+		for (const auto& event : recorder->_events)
+		{
+			double timeUS = std::chrono::duration<double, std::chrono::microseconds::period>(event.time - startTime).count();
+
+			file << (first ? "\n" : ",\n")
+				<< "{\"name\": \"" << event.name << "\", \"cat\": \"" << event.category << "\", \"ph\": \"" << event.type
+				<< "\", \"ts\": " << timeUS << ", \"pid\": 1, \"tid\": " << recorder->_threadId;
+
+			if (event.index != -1)
+				file << ", \"args\": {\"index\": " << event.index << "}";
+
+			file << "}";
+			first = false;
+		}
+	}
+
+	file << "\n]\n}\n";
+
+	return file.good();
+}
@@ -0,0 +1,51 @@
+#ifndef _TRACE_RECORDER_H_
+#define _TRACE_RECORDER_H_
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include "Triangulator.h"
+
+
+// Records the phases, and optionally the detail scopes, of the triangulators on one thread as a timeline.
+// Recorders of several threads are written together into one Chrome trace event file, which can be opened
+// in chrome://tracing or Perfetto.
+class TraceRecorder : public Triangulator::PhaseListener
+{
+public:
+	TraceRecorder(index_t threadId, bool recordDetails);
+
+	void OnPhaseBegin(Triangulator::Phase phase) override;
+	void OnPhaseEnd(Triangulator::Phase phase) override;
+	bool WantsDetails() const override { return _recordDetails; }
+	void OnDetailBegin(const char* name, index_t index) override;
+	void OnDetailEnd(const char* name, index_t index) override;
+
+	// Scopes of the caller, for example benchmark iterations.
+	void Begin(const char* name, index_t index = -1);
+	void End(const char* name, index_t index = -1);
+
+	int_t GetNumEvents() const { return _events.size(); }
+	void Clear() { _events.clear(); }
+
+	// Times start at the earliest event of all recorders.
+	static bool SaveJSON(const std::string& fileName, const std::vector<const TraceRecorder*>& recorders);
+
+private:
+	struct Event
+	{
+		const char* name;
+		const char* category;
+		index_t index;
+		char type;	// 'B' for begin, 'E' for end.
+		std::chrono::steady_clock::time_point time;
+	};
+
+	void AddEvent(const char* name, const char* category, index_t index, char type);
+
+	index_t _threadId;
+	bool _recordDetails;
+	std::vector<Event> _events;
+};
+
+#endif // _TRACE_RECORDER_H_
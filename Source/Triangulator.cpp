@@ -0,0 +1,616 @@
+#include "Triangulator.h"
+#include <cassert>
+#include <algorithm>
+#include <numeric>
+#include <set>
+#include <Math/geometry.h>
+#include "SeidelTriangulator.h"
+#include "SweepTriangulator.h"
+
+
+thread_local Triangulator::PhaseListener* Triangulator::_phaseListener = nullptr;
+
+void CoordArray::SetView(const math3d::vec2f* coords, index_t size)
+{
+	_owned = { };
+	_data = coords;
+	_size = size;
+	_isView = true;
+}
+
+void CoordArray::Clear()
+{
+	_owned.clear();
+	_isView = false;
+	Update();
+}
+
+void CoordArray::Resize(index_t size)
+{
+	Edit().resize(size);
+	Update();
+}
+
+// Owned storage for an edit, the first edit of a view copies it.
+std::vector<math3d::vec2f>& CoordArray::Edit()
+{
+	if (_isView)
+	{
+		_owned.assign(_data, _data + _size);
+		_isView = false;
+	}
+
+	return _owned;
+}
+
+void Triangulator::InitPolygon(const OutlineList& outlines)
+{
+	bool validOutlines;
+
+	{
+		ScopedPhase initPhase(Phase::Init);
+
+		// Copy all points to a single array.
+		_outlineOffsets.push_back(0);
+		for (auto& outl : outlines)
+		{
+			_pointCoords.Append(outl.begin(), outl.end());
+			_outlineOffsets.push_back(_pointCoords.size());
+		}
+
+		validOutlines = SetupOutlines();
+	}
+
+	ScopedPhase validationPhase(Phase::Validation);
+	_isSimplePolygon = validOutlines && CheckIfSimplePolygon();
+}
+
+void Triangulator::InitPolygon(const math3d::vec2f* pointCoords, const index_t* outlineOffsets, index_t numOutlines)
+{
+	bool validOutlines;
+
+	{
+		ScopedPhase initPhase(Phase::Init);
+
+		_pointCoords.SetView(pointCoords, outlineOffsets[numOutlines]);
+		_outlineOffsets.assign(outlineOffsets, outlineOffsets + numOutlines + 1);
+
+		validOutlines = SetupOutlines();
+	}
+
+	ScopedPhase validationPhase(Phase::Validation);
+	_isSimplePolygon = validOutlines && CheckIfSimplePolygon();
+}
+
+void Triangulator::DeinitPolygon()
+{
+	_pointCoords.Clear();
+	_segments.clear();
+	_outlinesWinding.clear();
+	_outlineOffsets.clear();
+
+	_isSimplePolygon = false;
+}
+
+// Set up the segments and the winding of all outlines. Returns false if an outline has less than 3 vertices.
+bool Triangulator::SetupOutlines()
+{
+	index_t numOutlines = _outlineOffsets.size() - 1;
+	bool valid = true;
+
+	_segments.resize(_pointCoords.size());
+	_outlinesWinding.resize(numOutlines);
+
+	for (index_t outlIndex = 0; outlIndex < numOutlines; ++outlIndex)
+	{
+		if (_outlineOffsets[outlIndex + 1] - _outlineOffsets[outlIndex] < 3)
+			valid = false;
+
+		for (index_t ptIndex = _outlineOffsets[outlIndex]; ptIndex < _outlineOffsets[outlIndex + 1]; ++ptIndex)
+			SetupSegment(ptIndex);
+
+		UpdateOutlineWinding(outlIndex);
+	}
+
+	return valid;
+}
+
+// Segment i connects point i with the next point of the same outline.
+void Triangulator::SetupSegment(index_t segIndex)
+{
+	Segment& seg = _segments[segIndex];
+	index_t ptAIndex = segIndex;
+	index_t ptBIndex = NextPointIndex(segIndex);
+
+	// Determine which point is lower and which is upper.
+	if (PointsVerticalRelation(_pointCoords[ptAIndex], _pointCoords[ptBIndex]) == VerticalRelation::Below)
+	{
+		seg.lowerPointIndex = ptAIndex;
+		seg.upperPointIndex = ptBIndex;
+		seg.upward = true;
+	}
+	else
+	{
+		seg.lowerPointIndex = ptBIndex;
+		seg.upperPointIndex = ptAIndex;
+		seg.upward = false;
+	}
+
+	// Is the lower point located to the left of the upper point?
+	bool lowerLeft = (PointsHorizontalRelation(_pointCoords[seg.lowerPointIndex], _pointCoords[seg.upperPointIndex]) == HorizontalRelation::Left);
+
+	if (lowerLeft)
+	{
+		seg.leftPointIndex = seg.lowerPointIndex;
+		seg.rightPointIndex = seg.upperPointIndex;
+	}
+	else
+	{
+		seg.leftPointIndex = seg.upperPointIndex;
+		seg.rightPointIndex = seg.lowerPointIndex;
+	}
+
+	seg.line = math3d::line_from_points_2d(_pointCoords[seg.lowerPointIndex], _pointCoords[seg.upperPointIndex]);
+}
+
+void Triangulator::UpdateOutlineWinding(index_t outlineIndex)
+{
+	float windingSum = 0.0f;
+
+	for (index_t ptIndex = _outlineOffsets[outlineIndex]; ptIndex < _outlineOffsets[outlineIndex + 1]; ++ptIndex)
+	{
+		const auto& ptA = _pointCoords[ptIndex];
+		const auto& ptB = _pointCoords[NextPointIndex(ptIndex)];
+		windingSum += (ptB.x - ptA.x) * (ptB.y + ptA.y);
+	}
+
+	// Winding for this ouline is clockwise if the sum is greater than 0.
+	_outlinesWinding[outlineIndex] = (windingSum > 0.0f) ? Winding::CW : Winding::CCW;
+}
+
+index_t Triangulator::OutlineOfPoint(index_t pointIndex) const
+{
+	return std::upper_bound(_outlineOffsets.begin(), _outlineOffsets.end(), pointIndex) - _outlineOffsets.begin() - 1;
+}
+
+index_t Triangulator::NextPointIndex(index_t pointIndex) const
+{
+	index_t outlIndex = OutlineOfPoint(pointIndex);
+	return (pointIndex + 1 < _outlineOffsets[outlIndex + 1]) ? pointIndex + 1 : _outlineOffsets[outlIndex];
+}
+
+void Triangulator::SetPolygon(const OutlineList& outlines)
+{
+	DeinitPolygon();
+	InitPolygon(outlines);
+
+	ScopedPhase phase(Phase::Init);
+	OnPolygonEdited();
+}
+
+void Triangulator::SetPolygon(const math3d::vec2f* pointCoords, const index_t* outlineOffsets, index_t numOutlines)
+{
+	DeinitPolygon();
+	InitPolygon(pointCoords, outlineOffsets, numOutlines);
+
+	ScopedPhase phase(Phase::Init);
+	OnPolygonEdited();
+}
+
+bool Triangulator::AddOutline(const Outline& outline)
+{
+	if (outline.size() < 3)
+		return false;
+
+	index_t firstPtIndex = _pointCoords.size();
+	_pointCoords.Append(outline.begin(), outline.end());
+	_segments.resize(_pointCoords.size());
+	_outlineOffsets.push_back(_pointCoords.size());
+	_outlinesWinding.emplace_back();
+
+	for (index_t ptIndex = firstPtIndex; ptIndex < _pointCoords.size(); ++ptIndex)
+		SetupSegment(ptIndex);
+
+	IndexList newSegIndices(outline.size());
+	std::iota(newSegIndices.begin(), newSegIndices.end(), firstPtIndex);
+
+	if (!ValidateEdit(newSegIndices))
+	{
+		_pointCoords.Resize(firstPtIndex);
+		_segments.resize(firstPtIndex);
+		_outlineOffsets.pop_back();
+		_outlinesWinding.pop_back();
+		return false;
+	}
+
+	UpdateOutlineWinding(_outlinesWinding.size() - 1);
+	OnOutlineAdded(firstPtIndex);
+
+	return true;
+}
+
+// Check whether the polygon is still simple after the given segments have changed. If it was simple before,
+// only the changed segments are tested against the others. Otherwise the whole polygon is validated again
+// and the edit is always accepted.
+bool Triangulator::ValidateEdit(const IndexList& changedSegIndices)
+{
+	if (!_isSimplePolygon)
+	{
+		_isSimplePolygon = CheckIfSimplePolygon();
+		return true;
+	}
+
+	// Testing many segments one by one costs more than a single sweep over the whole polygon.
+	if (changedSegIndices.size() > 32)
+		return CheckIfSimplePolygon();
+
+	// One pass over the points and one over the segments, each tested against all changed segments.
+	for (index_t ptIndex = 0; ptIndex < _pointCoords.size(); ++ptIndex)
+	{
+		const auto& pt = _pointCoords[ptIndex];
+
+		// No two equal points are allowed.
+		for (index_t segIndex : changedSegIndices)
+		{
+			const auto& seg = _segments[segIndex];
+			if ((ptIndex != seg.upperPointIndex && pt == _pointCoords[seg.upperPointIndex]) ||
+				(ptIndex != seg.lowerPointIndex && pt == _pointCoords[seg.lowerPointIndex]))
+			{
+				return false;
+			}
+		}
+	}
+
+	for (index_t otherIndex = 0; otherIndex < _segments.size(); ++otherIndex)
+	{
+		const auto& other = _segments[otherIndex];
+		const auto& otherUpperPt = _pointCoords[other.upperPointIndex];
+		const auto& otherLowerPt = _pointCoords[other.lowerPointIndex];
+
+		for (index_t segIndex : changedSegIndices)
+		{
+			if (otherIndex == segIndex)
+				continue;
+
+			const auto& seg = _segments[segIndex];
+			const auto& upperPt = _pointCoords[seg.upperPointIndex];
+			const auto& lowerPt = _pointCoords[seg.lowerPointIndex];
+
+			if (std::max(otherUpperPt.x, otherLowerPt.x) < std::min(upperPt.x, lowerPt.x) ||
+				std::min(otherUpperPt.x, otherLowerPt.x) > std::max(upperPt.x, lowerPt.x) ||
+				otherLowerPt.y > upperPt.y || otherUpperPt.y < lowerPt.y)
+			{
+				continue;
+			}
+
+			bool adjacent =
+				seg.lowerPointIndex == other.lowerPointIndex || seg.upperPointIndex == other.lowerPointIndex ||
+				seg.lowerPointIndex == other.upperPointIndex || seg.upperPointIndex == other.upperPointIndex;
+
+			// For adjacent segments use intersection test that excludes endpoints.
+			bool intersect = adjacent ?
+				math3d::do_line_segments_intersect_exclude_endpoints_2d(lowerPt, upperPt, otherLowerPt, otherUpperPt) :
+				math3d::do_line_segments_intersect_2d(lowerPt, upperPt, otherLowerPt, otherUpperPt);
+
+			if (intersect)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool Triangulator::CheckIfSimplePolygon()
+{
+	// Shamos-Hoey sweep line algorithm is used to detect whether any line segments intersect.
+
+	// A predicate for sorting segment point events.
+	auto sortSegPtEventsPred = [this](index_t segPt1, index_t segPt2) -> bool {
+		const auto& seg1 = _segments[std::abs(segPt1) - 1];
+		const auto& seg2 = _segments[std::abs(segPt2) - 1];
+		index_t pt1Index = (segPt1 > 0) ? seg1.leftPointIndex : seg1.rightPointIndex;
+		index_t pt2Index = (segPt2 > 0) ? seg2.leftPointIndex : seg2.rightPointIndex;
+		
+		// If it is one and the same point shared by the two segments, the one which is
+		// on the right of a segment is taken to be smaller.
+		if (pt1Index == pt2Index)
+			return (segPt1 < 0 && segPt2 > 0);
+		
+		const auto& pt1 = _pointCoords[pt1Index];
+		const auto& pt2 = _pointCoords[pt2Index];
+
+		// The point which is lexicographicaly on the left is smaller.
+		return PointsHorizontalRelation(pt1, pt2) == HorizontalRelation::Left;
+	};
+
+	// A predicate used in std::adjacent_find(), to find two points with identical coordinates in a sorted vector.
+	// Since each point appears twice, as a left point of a segment and as a right point of another
+	// segment, we need to treat each such pair as distinct.
+	auto adjEqPred = [this](index_t segPt1, index_t segPt2) -> bool {
+		const auto& seg1 = _segments[std::abs(segPt1) - 1];
+		const auto& seg2 = _segments[std::abs(segPt2) - 1];
+		index_t pt1Index = (segPt1 > 0) ? seg1.leftPointIndex : seg1.rightPointIndex;
+		index_t pt2Index = (segPt2 > 0) ? seg2.leftPointIndex : seg2.rightPointIndex;
+
+		// If both indices refer to the same point, it means it's the shared point of the two segments.
+		// Only looking for two different points with the same coordinates.
+		if (pt1Index == pt2Index)
+			return false;
+
+		return _pointCoords[pt1Index] == _pointCoords[pt2Index];
+	};
+
+	// A predicate used for finding a place to insert a segment into a sorted vector of segments.
+	// Segments are sorted by y coordinate of a new segment's left point and an intersection of
+	// a vertical line going through that point and another segment.
+	auto segOrderPred = [this](const Segment* otherSeg, const Segment* newSeg) -> bool {
+		const auto& leftEventPt = _pointCoords[newSeg->leftPointIndex];
+
+		// Segments that start in the same point are ordered by their directions. Intersecting the sweep line
+		// with the other segment would give the shared point only up to rounding.
+		if (otherSeg->leftPointIndex == newSeg->leftPointIndex)
+		{
+			const auto& otherRightPt = _pointCoords[otherSeg->rightPointIndex];
+			const auto& newRightPt = _pointCoords[newSeg->rightPointIndex];
+			double cross =
+				(double(otherRightPt.x) - leftEventPt.x) * (double(newRightPt.y) - leftEventPt.y) -
+				(double(otherRightPt.y) - leftEventPt.y) * (double(newRightPt.x) - leftEventPt.x);
+			return cross > 0.0;
+		}
+
+		// Find the intersection of the vertical sweep line and the other segment.
+		// If there is no intersection, use other segment's left point.
+		auto vertSweepLine = math3d::line_from_point_and_vec_2d(leftEventPt, math3d::vec2f_y_axis);
+		math3d::vec2f otherPt;
+		if (!math3d::intersect_lines_2d(otherPt, vertSweepLine, otherSeg->line))
+			otherPt = _pointCoords[otherSeg->leftPointIndex];
+
+		if (otherPt == leftEventPt)
+		{
+			// If points to be compared are the same, use right points of the segments.
+			// Return true if other segment's right point is below new segment's right point.
+			return (PointsVerticalRelation(_pointCoords[otherSeg->rightPointIndex], _pointCoords[newSeg->rightPointIndex]) == VerticalRelation::Below);
+		}
+		else
+		{
+			// Return true if other segment's point is below new segment's left point.
+			return (PointsVerticalRelation(otherPt, leftEventPt) == VerticalRelation::Below);
+		}
+	};
+
+	// The sweep status is ordered by segOrderPred. Only the segment being inserted is compared to the others,
+	// whose order doesn't change while none of them intersect. Segments are removed through their positions.
+	const Segment* newSeg = nullptr;
+	auto statusOrderPred = [&newSeg, &segOrderPred](const Segment* seg1, const Segment* seg2) -> bool {
+		return (seg2 == newSeg) ? segOrderPred(seg1, seg2) : !segOrderPred(seg2, seg1);
+	};
+
+	using SweepStatus = std::set<const Segment*, decltype(statusOrderPred)>;
+	SweepStatus sortedSegments(statusOrderPred);
+	std::vector<SweepStatus::iterator> segPositions(_segments.size(), sortedSegments.end());
+	std::vector<index_t> segPtEvents(_segments.size() * 2);
+
+	// Each segment produces two events, identified by the 1-based segment index.
+	// The index is positive for the left point of the segment and negative for the right point.
+	for (index_t i = 0; i < _segments.size(); ++i)
+	{
+		segPtEvents[2 * i] = i + 1;
+		segPtEvents[2 * i + 1] = -(i + 1);
+	}
+
+	std::sort(segPtEvents.begin(), segPtEvents.end(), sortSegPtEventsPred);
+
+	// No two equal points are allowed.
+	auto eqIt = std::adjacent_find(segPtEvents.begin(), segPtEvents.end(), adjEqPred);
+	if (eqIt != segPtEvents.end())
+		return false;
+
+	for (index_t segIndex : segPtEvents)
+	{
+		const Segment& seg = _segments[std::abs(segIndex) - 1];
+
+		if (segIndex > 0)
+		{
+			// The point is the left endpoint of segment (starts the segment).
+			newSeg = &seg;
+			auto insertPos = sortedSegments.insert(&seg).first;
+			segPositions[segIndex - 1] = insertPos;
+			const Segment* nextSeg = (std::next(insertPos) != sortedSegments.end()) ? *std::next(insertPos) : nullptr;
+			const Segment* prevSeg = (insertPos != sortedSegments.begin()) ? *std::prev(insertPos) : nullptr;
+
+			if (prevSeg != nullptr)
+			{
+				if (seg.lowerPointIndex == prevSeg->lowerPointIndex || seg.upperPointIndex == prevSeg->lowerPointIndex ||
+					seg.lowerPointIndex == prevSeg->upperPointIndex || seg.upperPointIndex == prevSeg->upperPointIndex)
+				{
+					// For adjacent segments use intersection test that excludes endpoints.
+					if (math3d::do_line_segments_intersect_exclude_endpoints_2d(
+						_pointCoords[seg.lowerPointIndex], _pointCoords[seg.upperPointIndex],
+						_pointCoords[prevSeg->lowerPointIndex], _pointCoords[prevSeg->upperPointIndex]))
+					{
+						return false;
+					}
+				}
+				else
+				{
+					if (math3d::do_line_segments_intersect_2d(
+						_pointCoords[seg.lowerPointIndex], _pointCoords[seg.upperPointIndex],
+						_pointCoords[prevSeg->lowerPointIndex], _pointCoords[prevSeg->upperPointIndex]))
+					{
+						return false;
+					}
+				}
+			}
+
+			if (nextSeg != nullptr)
+			{
+				if (seg.lowerPointIndex == nextSeg->lowerPointIndex || seg.upperPointIndex == nextSeg->lowerPointIndex ||
+					seg.lowerPointIndex == nextSeg->upperPointIndex || seg.upperPointIndex == nextSeg->upperPointIndex)
+				{
+					// For adjacent segments use intersection test that excludes endpoints.
+					if (math3d::do_line_segments_intersect_exclude_endpoints_2d(
+						_pointCoords[seg.lowerPointIndex], _pointCoords[seg.upperPointIndex],
+						_pointCoords[nextSeg->lowerPointIndex], _pointCoords[nextSeg->upperPointIndex]))
+					{
+						return false;
+					}
+				}
+				else
+				{
+					if (math3d::do_line_segments_intersect_2d(
+						_pointCoords[seg.lowerPointIndex], _pointCoords[seg.upperPointIndex],
+						_pointCoords[nextSeg->lowerPointIndex], _pointCoords[nextSeg->upperPointIndex]))
+					{
+						return false;
+					}
+				}
+			}
+
+		}
+		else
+		{
+			// The point is the right endpoint of segment (ends the segment).
+			auto segPos = segPositions[-segIndex - 1];
+
+			if (segPos != sortedSegments.end())
+			{
+				const Segment* nextSeg = (std::next(segPos) != sortedSegments.end()) ? *std::next(segPos) : nullptr;
+				const Segment* prevSeg = (segPos != sortedSegments.begin()) ? *std::prev(segPos) : nullptr;
+
+				if (prevSeg != nullptr && nextSeg != nullptr)
+				{
+					if (prevSeg->lowerPointIndex == nextSeg->lowerPointIndex || prevSeg->upperPointIndex == nextSeg->lowerPointIndex ||
+						prevSeg->lowerPointIndex == nextSeg->upperPointIndex || prevSeg->upperPointIndex == nextSeg->upperPointIndex)
+					{
+						// For adjacent segments use intersection test that excludes endpoints.
+						if (math3d::do_line_segments_intersect_exclude_endpoints_2d(
+							_pointCoords[prevSeg->lowerPointIndex], _pointCoords[prevSeg->upperPointIndex],
+							_pointCoords[nextSeg->lowerPointIndex], _pointCoords[nextSeg->upperPointIndex]))
+						{
+							return false;
+						}
+					}
+					else
+					{
+						if (math3d::do_line_segments_intersect_2d(
+							_pointCoords[prevSeg->lowerPointIndex], _pointCoords[prevSeg->upperPointIndex],
+							_pointCoords[nextSeg->lowerPointIndex], _pointCoords[nextSeg->upperPointIndex]))
+						{
+							return false;
+						}
+					}
+				}
+
+				sortedSegments.erase(segPos);
+			}
+			else
+			{
+				assert(false);
+			}
+		}
+	}
+
+	assert(sortedSegments.empty());
+
+	return true;
+}
+
+Triangulator::VerticalRelation Triangulator::PointsVerticalRelation(const math3d::vec2f& queryPoint, const math3d::vec2f& inRelationToPoint)
+{
+	// If two points have the same y coordinate, then the queryPoint is considered
+	// below the inRelationToPoint if it's x coordinate is smaller.
+	if (queryPoint.y < inRelationToPoint.y)
+		return VerticalRelation::Below;
+	else if (queryPoint.y > inRelationToPoint.y)
+		return VerticalRelation::Above;
+	else if (queryPoint.x < inRelationToPoint.x)
+		return VerticalRelation::Below;
+	else
+		return VerticalRelation::Above;
+}
+
+Triangulator::HorizontalRelation Triangulator::PointsHorizontalRelation(const math3d::vec2f& queryPoint, const math3d::vec2f& inRelationToPoint)
+{
+	if (queryPoint.x < inRelationToPoint.x)
+		return HorizontalRelation::Left;
+	else if (queryPoint.x > inRelationToPoint.x)
+		return HorizontalRelation::Right;
+	else if (queryPoint.y < inRelationToPoint.y)
+		return HorizontalRelation::Left;
+	else
+		return HorizontalRelation::Right;
+}
+
+const char* Triangulator::GetPhaseName(Phase phase)
+{
+	switch (phase)
+	{
+	case Phase::Init:
+		return "init";
+	case Phase::Validation:
+		return "validation";
+	case Phase::SegmentThreading:
+		return "segment_threading";
+	case Phase::InsideClassification:
+		return "inside_classification";
+	case Phase::MonotonePartition:
+		return "monotone_partition";
+	case Phase::Triangulation:
+		return "triangulation";
+	}
+
+	return "";
+}
+
+std::unique_ptr<Triangulator> CreateTriangulator(TriangulatorType type, const OutlineList& outlines)
+{
+	switch (type)
+	{
+	case TriangulatorType::Seidel:
+		return std::make_unique<SeidelTriangulator>(outlines);
+	case TriangulatorType::Sweep:
+		return std::make_unique<SweepTriangulator>(outlines);
+	}
+
+	return nullptr;
+}
+
+std::unique_ptr<Triangulator> CreateTriangulator(TriangulatorType type, const math3d::vec2f* pointCoords, const index_t* outlineOffsets, index_t numOutlines)
+{
+	switch (type)
+	{
+	case TriangulatorType::Seidel:
+		return std::make_unique<SeidelTriangulator>(pointCoords, outlineOffsets, numOutlines);
+	case TriangulatorType::Sweep:
+		return std::make_unique<SweepTriangulator>(pointCoords, outlineOffsets, numOutlines);
+	}
+
+	return nullptr;
+}
+
+const char* GetTriangulatorName(TriangulatorType type)
+{
+	switch (type)
+	{
+	case TriangulatorType::Seidel:
+		return "seidel";
+	case TriangulatorType::Sweep:
+		return "sweep";
+	}
+
+	return "";
+}
+
+bool ParseTriangulatorType(const std::string& name, TriangulatorType& type)
+{
+	for (auto t : { TriangulatorType::Seidel, TriangulatorType::Sweep })
+	{
+		if (name == GetTriangulatorName(t))
+		{
+			type = t;
+			return true;
+		}
+	}
+
+	return false;
+}
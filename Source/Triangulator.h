@@ -0,0 +1,249 @@
+#ifndef _TRIANGULATOR_H_
+#define _TRIANGULATOR_H_
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <Math/vec2.h>
+#include <Math/vec3.h>
+#include "Common.h"
+
+using Outline = std::vector<math3d::vec2f>;
+using OutlineList = std::vector<Outline>;
+using IndexList = std::vector<index_t>;
+
+
+// Point coordinates of a polygon. The array is either owned, or a read-only view of the caller's coordinates,
+// which is copied into owned storage only when the polygon is edited.
+class CoordArray
+{
+public:
+	index_t size() const { return _size; }
+	bool empty() const { return _size == 0; }
+	const math3d::vec2f* data() const { return _data; }
+	const math3d::vec2f* begin() const { return _data; }
+	const math3d::vec2f* end() const { return _data + _size; }
+	const math3d::vec2f& operator [] (index_t index) const { return _data[index]; }
+
+	bool IsView() const { return _isView; }
+	// The coordinates must stay valid and unchanged until the array is edited or cleared.
+	void SetView(const math3d::vec2f* coords, index_t size);
+	void Clear();
+
+	void Resize(index_t size);
+
+	template <class _It>
+	void Append(_It first, _It last)
+	{
+		auto& coords = Edit();
+		coords.insert(coords.end(), first, last);
+		Update();
+	}
+
+private:
+	std::vector<math3d::vec2f>& Edit();
+	void Update() { _data = _owned.data(); _size = _owned.size(); }
+
+	std::vector<math3d::vec2f> _owned;
+	const math3d::vec2f* _data = nullptr;
+	index_t _size = 0;
+	bool _isView = false;
+};
+
+
+// Common base of the triangulation engines. It holds the input polygon, shared by all
+// engines in the same form, and validates it on construction.
+class Triangulator
+{
+public:
+	enum class FillRule
+	{
+		NonZero,
+		EvenOdd,
+	};
+
+	enum class Winding
+	{
+		CW,
+		CCW,
+	};
+
+	// Parts of the algorithms that can be observed separately. Engines report the ones they have.
+	enum class Phase
+	{
+		Init,
+		Validation,
+		SegmentThreading, // Includes inserting the end points of the segments.
+		InsideClassification,
+		MonotonePartition,
+		Triangulation,
+		Count
+	};
+
+	class PhaseListener
+	{
+	public:
+		virtual ~PhaseListener() = default;
+		virtual void OnPhaseBegin(Phase phase) = 0;
+		virtual void OnPhaseEnd(Phase phase) = 0;
+
+		// Finer scopes inside the phases, such as single segment insertions. They are reported only to
+		// listeners that want them. The index identifies the element the scope works on.
+		virtual bool WantsDetails() const { return false; }
+		virtual void OnDetailBegin(const char* name, index_t index) { }
+		virtual void OnDetailEnd(const char* name, index_t index) { }
+	};
+
+	// Receives the triangles while they are produced, so that the whole index list doesn't have to be kept.
+	class TriangleSink
+	{
+	public:
+		virtual ~TriangleSink() = default;
+		// A batch of whole triangles, three indices each. The indices are valid only during the call.
+		virtual void AddTriangles(const index_t* indices, index_t numIndices) = 0;
+	};
+
+	struct Segment
+	{
+		index_t upperPointIndex;
+		index_t lowerPointIndex;
+		index_t leftPointIndex;
+		index_t rightPointIndex;
+		math3d::vec3f line;
+		bool upward;
+	};
+
+	virtual ~Triangulator() = default;
+
+	// The listener receives the phases of all triangulators used on the calling thread, including construction.
+	static void SetPhaseListener(PhaseListener* listener) { _phaseListener = listener; }
+	static const char* GetPhaseName(Phase phase);
+
+	bool IsSimplePolygon() const { return _isSimplePolygon; }
+	const std::vector<Segment>& GetLineSegments() const { return _segments; }
+	const CoordArray& GetPointCoords() const { return _pointCoords; }
+	const std::vector<Winding>& GetOutlinesWinding() const { return _outlinesWinding; }
+	// Index of the first point of each outline, followed by the total number of points.
+	const IndexList& GetOutlineOffsets() const { return _outlineOffsets; }
+
+	// Run the complete algorithm and output the triangle list. Returns false if the polygon is not simple.
+	virtual bool Triangulate(FillRule fillRule, Winding winding, IndexList& outTriangleIndices) = 0;
+	// Same, passing the triangles of each monotone piece to the sink as soon as it is triangulated.
+	virtual bool Triangulate(FillRule fillRule, Winding winding, TriangleSink& sink) = 0;
+
+	// Replace the whole polygon. The buffers keep their memory, so that one triangulator can be reused for many polygons.
+	void SetPolygon(const OutlineList& outlines);
+	// The coordinates are used in place, as by the constructors that take them.
+	void SetPolygon(const math3d::vec2f* pointCoords, const index_t* outlineOffsets, index_t numOutlines);
+
+	// Append an outline, such as a hole drawn in the editor. An outline that would make a simple polygon
+	// self-intersecting is rejected and false is returned. The Seidel engine threads the new segments into
+	// its existing tree instead of building it again.
+	bool AddOutline(const Outline& outline);
+
+protected:
+	enum class VerticalRelation
+	{
+		Above,
+		Below
+	};
+
+	enum class HorizontalRelation
+	{
+		Left,
+		Right
+	};
+
+	// Reports the phase to the listener for the lifetime of the object. Costs a single check without a listener.
+	class ScopedPhase
+	{
+	public:
+		ScopedPhase(Phase phase)
+			: _phase(phase), _listener(_phaseListener)
+		{
+			if (_listener != nullptr)
+				_listener->OnPhaseBegin(_phase);
+		}
+
+		~ScopedPhase()
+		{
+			if (_listener != nullptr)
+				_listener->OnPhaseEnd(_phase);
+		}
+
+	private:
+		Phase _phase;
+		PhaseListener* _listener;
+	};
+
+	// Reports a detail scope to a listener that wants details. The name has to outlive the listener's use of it.
+	class ScopedDetail
+	{
+	public:
+		ScopedDetail(const char* name, index_t index)
+			: _name(name), _index(index), _listener((_phaseListener != nullptr && _phaseListener->WantsDetails()) ? _phaseListener : nullptr)
+		{
+			if (_listener != nullptr)
+				_listener->OnDetailBegin(_name, _index);
+		}
+
+		~ScopedDetail()
+		{
+			if (_listener != nullptr)
+				_listener->OnDetailEnd(_name, _index);
+		}
+
+	private:
+		const char* _name;
+		index_t _index;
+		PhaseListener* _listener;
+	};
+
+	Triangulator() = default;
+
+	void InitPolygon(const OutlineList& outlines);
+	// The coordinates are used in place, see CoordArray::SetView(). The offsets are laid out as GetOutlineOffsets().
+	void InitPolygon(const math3d::vec2f* pointCoords, const index_t* outlineOffsets, index_t numOutlines);
+	void DeinitPolygon();
+
+	// Called after the polygon has been set or replaced.
+	virtual void OnPolygonEdited() {}
+	// Called after an outline has been appended. Its segments start at firstSegIndex.
+	virtual void OnOutlineAdded(index_t firstSegIndex) { OnPolygonEdited(); }
+
+	index_t NextPointIndex(index_t pointIndex) const;
+
+	static VerticalRelation PointsVerticalRelation(const math3d::vec2f& queryPoint, const math3d::vec2f& inRelationToPoint);
+	static HorizontalRelation PointsHorizontalRelation(const math3d::vec2f& queryPoint, const math3d::vec2f& inRelationToPoint);
+
+	CoordArray _pointCoords;
+	std::vector<Segment> _segments;
+	std::vector<Winding> _outlinesWinding;
+	IndexList _outlineOffsets;
+	bool _isSimplePolygon = false;
+
+private:
+	static thread_local PhaseListener* _phaseListener;
+
+	bool SetupOutlines();
+	bool CheckIfSimplePolygon();
+	bool ValidateEdit(const IndexList& changedSegIndices);
+	void SetupSegment(index_t segIndex);
+	void UpdateOutlineWinding(index_t outlineIndex);
+	index_t OutlineOfPoint(index_t pointIndex) const;
+};
+
+
+enum class TriangulatorType
+{
+	Seidel,
+	Sweep,
+};
+
+std::unique_ptr<Triangulator> CreateTriangulator(TriangulatorType type, const OutlineList& outlines);
+// Triangulator reading the coordinates in place, they must outlive it.
+std::unique_ptr<Triangulator> CreateTriangulator(TriangulatorType type, const math3d::vec2f* pointCoords, const index_t* outlineOffsets, index_t numOutlines);
+const char* GetTriangulatorName(TriangulatorType type);
+bool ParseTriangulatorType(const std::string& name, TriangulatorType& type);
+
+#endif // _TRIANGULATOR_H_